@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "AssetCache.h"
+#include "MappedFile.h"
+#include "ObjImporter.h"
+
+namespace dae
+{
+	namespace
+	{
+		//FNV-1a
+		uint64_t HashContents(const MappedFile& file, uint64_t seed)
+		{
+			uint64_t hash{ 14695981039346656037ull ^ seed };
+			for (size_t i{}; i < file.GetSize(); ++i)
+			{
+				hash ^= static_cast<uint8_t>(file.GetData()[i]);
+				hash *= 1099511628211ull;
+			}
+			return hash;
+		}
+
+		template<typename Asset>
+		std::shared_ptr<Asset> FindAsset(const std::unordered_map<uint64_t, std::shared_ptr<Asset>>& assets, uint64_t contentHash)
+		{
+			const auto it{ assets.find(contentHash) };
+			return it != assets.end() ? it->second : nullptr;
+		}
+	}
+
+	std::shared_ptr<SDL_Surface> AssetCache::LoadSurface(const std::string& path)
+	{
+		if (const auto it{ m_ImagePaths.find(path) }; it != m_ImagePaths.end())
+		{
+			if (std::shared_ptr<SDL_Surface> pImage{ FindAsset(m_Images, it->second) })
+			{
+				++m_NrShared;
+				return pImage;
+			}
+		}
+
+		const MappedFile file{ path };
+		if (!file.IsValid())
+			return nullptr;
+
+		//Same contents under another path
+		const uint64_t contentHash{ HashContents(file, 0) };
+		m_ImagePaths[path] = contentHash;
+		if (std::shared_ptr<SDL_Surface> pImage{ FindAsset(m_Images, contentHash) })
+		{
+			++m_NrShared;
+			return pImage;
+		}
+
+		//Decode straight from the mapped file
+		SDL_Surface* pSurface{ IMG_Load_RW(SDL_RWFromConstMem(file.GetData(), static_cast<int>(file.GetSize())), 1) };
+		if (!pSurface)
+			return nullptr;
+
+		++m_NrDecoded;
+		std::shared_ptr<SDL_Surface> pImage{ pSurface, SDL_FreeSurface };
+		m_Images.emplace(contentHash, pImage);
+		return pImage;
+	}
+
+	std::shared_ptr<const MeshData> AssetCache::LoadMesh(const std::string& path, const MeshImportOptions& options)
+	{
+		//The same OBJ imported with other options is another mesh
+		const uint32_t flags{ MeshCache::GetFlags(options) };
+		const std::string key{ path + '|' + std::to_string(flags) };
+		if (const auto it{ m_MeshPaths.find(key) }; it != m_MeshPaths.end())
+		{
+			if (std::shared_ptr<const MeshData> pMesh{ FindAsset(m_Meshes, it->second) })
+			{
+				++m_NrShared;
+				return pMesh;
+			}
+		}
+
+		//The cache header holds the hash of the OBJ it was built from, the OBJ is only read when the cache is missing or stale
+		const MeshCache::MappedMesh cache{ path, options };
+		uint64_t contentHash{};
+		if (cache.IsValid())
+		{
+			contentHash = cache.GetContentHash();
+		}
+		else
+		{
+			const MappedFile file{ path };
+			if (!file.IsValid())
+				return nullptr;
+
+			contentHash = HashContents(file, flags);
+		}
+		m_MeshPaths[key] = contentHash;
+		if (std::shared_ptr<const MeshData> pMesh{ FindAsset(m_Meshes, contentHash) })
+		{
+			++m_NrShared;
+			return pMesh;
+		}
+
+		const auto pMesh{ std::make_shared<MeshData>() };
+		if (cache.IsValid())
+		{
+			pMesh->vertices.assign(cache.GetVertices().begin(), cache.GetVertices().end());
+			pMesh->indices.assign(cache.GetIndices().begin(), cache.GetIndices().end());
+			pMesh->boundsMin = cache.GetBoundsMin();
+			pMesh->boundsMax = cache.GetBoundsMax();
+		}
+		else
+		{
+			if (!ObjImporter::Import(path, options, pMesh->vertices, pMesh->indices))
+				return nullptr;
+
+			MeshCache::CalculateBounds(pMesh->vertices, pMesh->boundsMin, pMesh->boundsMax);
+			MeshCache::Write(path, options, contentHash, pMesh->vertices, pMesh->indices, pMesh->boundsMin, pMesh->boundsMax);
+		}
+
+		++m_NrDecoded;
+		m_Meshes.emplace(contentHash, pMesh);
+		return pMesh;
+	}
+
+	void AssetCache::ReleaseUnused()
+	{
+		const auto release = [](auto& assets)
+		{
+			std::erase_if(assets, [](const auto& asset) { return asset.second.use_count() == 1; });
+		};
+		release(m_Images);
+		release(m_Meshes);
+
+		std::cout << "Assets: " << m_NrDecoded << " decoded, " << m_NrShared << " shared, " << m_Images.size() + m_Meshes.size() << " kept by the renderers\n";
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MeshCache.h"
+
+struct SDL_Surface;
+
+namespace dae
+{
+	//Welded, optimized triangle list in the layout both backends convert from
+	struct MeshData
+	{
+		std::vector<MeshCache::CachedVertex> vertices{};
+		std::vector<uint32_t> indices{};
+
+		//Object space box around the positions
+		Vector3 boundsMin{};
+		Vector3 boundsMax{};
+	};
+
+	//Decodes every image and mesh once and hands the same copy to both renderers.
+	//Assets are keyed by the hash of the file contents, so the same file under another path is shared too.
+	//Meshes take that hash from the header of their mesh cache, the OBJ is only hashed when it gets imported.
+	class AssetCache final
+	{
+	public:
+		AssetCache() = default;
+
+		AssetCache(const AssetCache&) = delete;
+		AssetCache(AssetCache&&) noexcept = delete;
+		AssetCache& operator=(const AssetCache&) = delete;
+		AssetCache& operator=(AssetCache&&) noexcept = delete;
+
+		//nullptr when the file can't be read or decoded
+		std::shared_ptr<SDL_Surface> LoadSurface(const std::string& path);
+		std::shared_ptr<const MeshData> LoadMesh(const std::string& path, const MeshImportOptions& options = {});
+
+		//The cache holds a reference itself, drop every asset no renderer kept
+		void ReleaseUnused();
+
+	private:
+		std::unordered_map<uint64_t, std::shared_ptr<SDL_Surface>> m_Images{};
+		std::unordered_map<uint64_t, std::shared_ptr<const MeshData>> m_Meshes{};
+
+		//Skips hashing the file again when the same path is asked twice
+		std::unordered_map<std::string, uint64_t> m_ImagePaths{};
+		std::unordered_map<std::string, uint64_t> m_MeshPaths{};
+
+		uint32_t m_NrDecoded{};
+		uint32_t m_NrShared{};
+	};
+}
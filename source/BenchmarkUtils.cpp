@@ -0,0 +1,135 @@
+#include "pch.h"
+#include "BenchmarkUtils.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+namespace dae
+{
+	namespace Utils
+	{
+		namespace
+		{
+			bool ParseInt(const char* pText, int minimum, int& value)
+			{
+				char* pEnd{};
+				const long parsed{ std::strtol(pText, &pEnd, 10) };
+				if (pEnd == pText || *pEnd != '\0' || parsed < minimum || parsed > INT_MAX)
+					return false;
+
+				value = static_cast<int>(parsed);
+				return true;
+			}
+
+			bool ParsePercent(const char* pText, float& value)
+			{
+				char* pEnd{};
+				const float parsed{ std::strtof(pText, &pEnd) };
+				if (pEnd == pText || *pEnd != '\0' || !(parsed >= 0.f))
+					return false;
+
+				value = parsed;
+				return true;
+			}
+		}
+
+		bool HasArgument(int argc, char* args[], const char* pFlag)
+		{
+			for (int i{ 1 }; i < argc; ++i)
+			{
+				if (std::strcmp(args[i], pFlag) == 0)
+					return true;
+			}
+			return false;
+		}
+
+		ArgumentReader::ArgumentReader(int argc, char* args[], std::string& error)
+			: m_NrArguments{ argc }
+			, m_pArguments{ args }
+			, m_Error{ error }
+		{
+		}
+
+		bool ArgumentReader::Next()
+		{
+			if (++m_Index >= m_NrArguments)
+				return false;
+
+			m_Current = m_pArguments[m_Index];
+			return true;
+		}
+
+		bool ArgumentReader::TakeInt(int minimum, int& value)
+		{
+			if (m_Index + 1 >= m_NrArguments || !ParseInt(m_pArguments[m_Index + 1], minimum, value))
+			{
+				m_Error = m_Current + " needs a whole number of at least " + std::to_string(minimum);
+				return false;
+			}
+			++m_Index;
+			return true;
+		}
+
+		bool ArgumentReader::TakePercent(float& value)
+		{
+			if (m_Index + 1 >= m_NrArguments || !ParsePercent(m_pArguments[m_Index + 1], value))
+			{
+				m_Error = m_Current + " needs a percentage";
+				return false;
+			}
+			++m_Index;
+			return true;
+		}
+
+		bool ArgumentReader::TakeValue(std::string& value, const char* pDescription)
+		{
+			if (m_Index + 1 >= m_NrArguments)
+			{
+				m_Error = m_Current + " needs " + pDescription;
+				return false;
+			}
+			value = m_pArguments[++m_Index];
+			return true;
+		}
+
+		bool ArgumentReader::SetUnknown()
+		{
+			m_Error = "unknown argument " + m_Current;
+			return false;
+		}
+
+		Baselines ReadBaselines(const std::string& path)
+		{
+			Baselines baselines{};
+			std::ifstream file{ path };
+			std::string line{};
+			std::getline(file, line);
+			while (std::getline(file, line))
+			{
+				const size_t separator{ line.rfind(',') };
+				if (separator == std::string::npos)
+					continue;
+
+				baselines[line.substr(0, separator)] = std::strtod(line.c_str() + separator + 1, nullptr);
+			}
+			return baselines;
+		}
+
+		bool WriteBaselines(const std::string& path, const std::string& header, const Baselines& baselines)
+		{
+			std::ofstream file{ path, std::ios::trunc };
+			if (!file)
+				return false;
+
+			//Whole nanoseconds stay whole numbers, fractions keep enough digits to round trip
+			file << header << '\n' << std::setprecision(15);
+			for (const auto& [name, value] : baselines)
+			{
+				file << name << ',' << value << '\n';
+			}
+			return static_cast<bool>(file);
+		}
+	}
+}
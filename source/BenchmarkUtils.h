@@ -0,0 +1,48 @@
+#pragma once
+#include <map>
+#include <string>
+
+namespace dae
+{
+	//Shared by the command line modes: --headless, --regression and --microbench
+	namespace Utils
+	{
+		//True when one of the arguments is exactly pFlag, picks the mode before anything is parsed
+		bool HasArgument(int argc, char* args[], const char* pFlag);
+
+		//Walks the arguments after the program name, the Take functions consume the value after the current argument.
+		//A failed Take leaves its message in the error string that was passed in, so ParseArguments can just return false.
+		class ArgumentReader final
+		{
+		public:
+			ArgumentReader(int argc, char* args[], std::string& error);
+
+			//Moves to the next argument, false after the last one
+			bool Next();
+			const std::string& GetCurrent() const { return m_Current; }
+
+			bool TakeInt(int minimum, int& value);
+			//Zero or more
+			bool TakePercent(float& value);
+			//Any text, pDescription ends up in the error message
+			bool TakeValue(std::string& value, const char* pDescription = "a value");
+
+			//Always false, for the last else of a parser
+			bool SetUnknown();
+
+		private:
+			int m_NrArguments;
+			char** m_pArguments;
+			std::string& m_Error;
+			int m_Index{};
+			std::string m_Current{};
+		};
+
+		//Name to a time in nanoseconds, sorted by name so the file diffs cleanly
+		using Baselines = std::map<std::string, double>;
+
+		//One "name,value" line per entry after a header line, a missing file is an empty set of baselines
+		Baselines ReadBaselines(const std::string& path);
+		bool WriteBaselines(const std::string& path, const std::string& header, const Baselines& baselines);
+	}
+}
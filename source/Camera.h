@@ -1,10 +1,12 @@
 #pragma once
 #include <SDL_keyboard.h>
 #include <SDL_mouse.h>
+#include <array>
 #include <chrono>
 
 #include "Math.h"
 #include "Timer.h"
+#include "GlobalDefinitions.h"
 
 namespace dae
 {
@@ -34,6 +36,13 @@ namespace dae
 		Matrix invViewMatrix{};
 		Matrix viewMatrix{};
 		Matrix projectionMatrix{};
+		Matrix viewProjectionMatrix{};
+
+		//Bumped whenever viewProjectionMatrix changes, cached per mesh matrices compare against it
+		uint32_t viewProjectionVersion{};
+
+		//World space planes of viewMatrix * projectionMatrix, normal points inside: left, right, bottom, top, near, far
+		std::array<Vector4, 6> frustumPlanes{};
 
 		void Initialize(float _aspectRatio, float _fovAngle = 90.f, const Vector3& _origin = {0.f,0.f,0.f})
 		{
@@ -58,6 +67,7 @@ namespace dae
 			};
 
 			viewMatrix = invViewMatrix.Inverse();
+			CalculateViewProjectionMatrix();
 
 			//TODO W1
 			//ONB => invViewMatrix
@@ -70,12 +80,83 @@ namespace dae
 		void CalculateProjectionMatrix()
 		{
 			projectionMatrix = Matrix::CreatePerspectiveFovLH(fov, aspectRatio, nearC, farC);
+			CalculateViewProjectionMatrix();
 			//TODO W2
 
 			//ProjectionMatrix => Matrix::CreatePerspectiveFovLH(...) [not implemented yet]
 			//DirectX Implementation => https://learn.microsoft.com/en-us/windows/win32/direct3d9/d3dxmatrixperspectivefovlh
 		}
 
+		void CalculateViewProjectionMatrix()
+		{
+			viewProjectionMatrix = viewMatrix * projectionMatrix;
+			++viewProjectionVersion;
+			CalculateFrustumPlanes();
+		}
+
+		void CalculateFrustumPlanes()
+		{
+			//Row vectors, so the planes come from the columns of the combined matrix
+			const auto getColumn = [this](int index)
+			{
+				return Vector4{ viewProjectionMatrix[0][index], viewProjectionMatrix[1][index], viewProjectionMatrix[2][index], viewProjectionMatrix[3][index] };
+			};
+			const Vector4 x{ getColumn(0) };
+			const Vector4 y{ getColumn(1) };
+			const Vector4 z{ getColumn(2) };
+			const Vector4 w{ getColumn(3) };
+
+			frustumPlanes = { w + x, w - x, w + y, w - y, z, w - z };
+			for (Vector4& plane : frustumPlanes)
+			{
+				plane = plane * (1.f / plane.GetXYZ().Magnitude());
+			}
+		}
+
+		bool IsSphereInFrustum(const Vector3& center, float radius) const
+		{
+			for (const Vector4& plane : frustumPlanes)
+			{
+				if (Vector3::Dot(plane.GetXYZ(), center) + plane.w < -radius)
+					return false;
+			}
+			return true;
+		}
+
+		bool IsBoxInFrustum(const Vector3& center, const Vector3& extents) const
+		{
+			for (const Vector4& plane : frustumPlanes)
+			{
+				const float projectedExtent{ std::abs(plane.x) * extents.x + std::abs(plane.y) * extents.y + std::abs(plane.z) * extents.z };
+				if (Vector3::Dot(plane.GetXYZ(), center) + plane.w < -projectedExtent)
+					return false;
+			}
+			return true;
+		}
+
+		//Bounding sphere first, the box only for meshes the sphere can't reject
+		bool IsInFrustum(const GlobalMesh& mesh) const
+		{
+			const Matrix& worldMatrix{ *mesh.pWorldMatrix };
+			const Vector3 axisX{ worldMatrix.GetAxisX() };
+			const Vector3 axisY{ worldMatrix.GetAxisY() };
+			const Vector3 axisZ{ worldMatrix.GetAxisZ() };
+
+			const float maxScale{ sqrtf(std::max({ axisX.SqrMagnitude(), axisY.SqrMagnitude(), axisZ.SqrMagnitude() })) };
+			if (!IsSphereInFrustum(worldMatrix.TransformPoint(mesh.boundsCenter), mesh.boundsRadius * maxScale))
+				return false;
+
+			//World space box around the transformed box
+			const Vector3 extents{ (mesh.boundsMax - mesh.boundsMin) * 0.5f };
+			const Vector3 worldExtents
+			{
+				std::abs(axisX.x) * extents.x + std::abs(axisY.x) * extents.y + std::abs(axisZ.x) * extents.z,
+				std::abs(axisX.y) * extents.x + std::abs(axisY.y) * extents.y + std::abs(axisZ.y) * extents.z,
+				std::abs(axisX.z) * extents.x + std::abs(axisY.z) * extents.y + std::abs(axisZ.z) * extents.z
+			};
+			return IsBoxInFrustum(worldMatrix.TransformPoint((mesh.boundsMin + mesh.boundsMax) * 0.5f), worldExtents);
+		}
+
 		void Update(const Timer* pTimer)
 		{
 			float deltaTime = pTimer->GetElapsed();
@@ -133,7 +214,24 @@ namespace dae
 				origin.y -= mouseY * cameraSpeed * deltaTime;
 			}
 
-			forward = Matrix::CreateRotation(totalPitch, totalYaw, 0.f).TransformVector(Vector3::UnitZ);
+			UpdateMatrices();
+		}
+
+		//Rebuilds the view matrix from origin, totalPitch and totalYaw, scripted cameras set those and call this
+		void UpdateMatrices()
+		{
+			//Nothing moved, the matrices and everything cached from them stay valid
+			const bool isRotated{ totalPitch != viewPitch || totalYaw != viewYaw };
+			if (!isRotated && origin == viewOrigin)
+				return;
+
+			if (isRotated)
+			{
+				forward = Matrix::CreateRotation(totalPitch, totalYaw, 0.f).TransformVector(Vector3::UnitZ);
+			}
+			viewOrigin = origin;
+			viewPitch = totalPitch;
+			viewYaw = totalYaw;
 
 			//Update Matrices
 			CalculateViewMatrix();
@@ -151,6 +249,11 @@ namespace dae
 		private:
 		float fovAngle{90.f};
 		float aspectRatio;
+
+		//Origin and angles the view matrix was built from, NaN so the first update always builds it
+		Vector3 viewOrigin{ NAN, NAN, NAN };
+		float viewPitch{ NAN };
+		float viewYaw{ NAN };
 		public:
 		float fov{ tanf((fovAngle * TO_RADIANS) / 2.f) };
 	};
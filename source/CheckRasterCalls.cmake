@@ -0,0 +1,57 @@
+#Fails when a DrawTriangle instantiation in SoftwareRenderer.cpp calls out to another function.
+#Everything the raster kernels use is forced inline (MATH_INLINE, MATH_INLINE_LAMBDA), a call in there is a per pixel call.
+#Run by ctest: cmake -DOBJDUMP=<objdump> -DOBJECTS=<object files of the target> -P CheckRasterCalls.cmake
+
+list(FILTER OBJECTS INCLUDE REGEX "SoftwareRenderer\\.cpp\\.o(bj)?$")
+if(NOT OBJECTS)
+	message(FATAL_ERROR "No object file for SoftwareRenderer.cpp")
+endif()
+
+set(disassembly "${CMAKE_CURRENT_BINARY_DIR}/SoftwareRenderer.disassembly.txt")
+execute_process(COMMAND ${OBJDUMP} -dr --no-show-raw-insn ${OBJECTS} OUTPUT_FILE ${disassembly} RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+	message(FATAL_ERROR "${OBJDUMP} failed on ${OBJECTS}")
+endif()
+
+#Function labels, calls and the relocation after a call that names the callee.
+#Names stay mangled, demangled names have brackets and those split CMake lists.
+file(STRINGS ${disassembly} lines REGEX "(>:$|\tcall|R_X86_64_)")
+file(REMOVE ${disassembly})
+
+set(nrKernels 0)
+set(nrCalls 0)
+set(isKernel FALSE)
+set(callee "")
+foreach(line IN LISTS lines)
+	#The call itself only points at its own relocation, the line after it names the callee
+	if(callee AND line MATCHES "R_X86_64_[A-Z0-9]+[ \t]+([^ \t]+)$")
+		set(callee "${CMAKE_MATCH_1}")
+	endif()
+	if(callee)
+		message(STATUS "${function} calls ${callee}")
+		set(callee "")
+	endif()
+
+	if(line MATCHES "^[0-9a-f]+ <([^>]+)>:$")
+		set(function "${CMAKE_MATCH_1}")
+		set(isKernel FALSE)
+		if(function MATCHES "DrawTriangle")
+			set(isKernel TRUE)
+			math(EXPR nrKernels "${nrKernels} + 1")
+		endif()
+	elseif(isKernel AND line MATCHES "\tcall[a-z]*[ \t]+(.*)$")
+		math(EXPR nrCalls "${nrCalls} + 1")
+		set(callee "${CMAKE_MATCH_1}")
+	endif()
+endforeach()
+if(callee)
+	message(STATUS "${function} calls ${callee}")
+endif()
+
+if(nrKernels EQUAL 0)
+	message(FATAL_ERROR "No DrawTriangle instantiation in ${OBJECTS}")
+endif()
+if(nrCalls GREATER 0)
+	message(FATAL_ERROR "${nrCalls} calls in ${nrKernels} DrawTriangle instantiations, demangle the names above with c++filt")
+endif()
+message(STATUS "${nrKernels} DrawTriangle instantiations, no calls")
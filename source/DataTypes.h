@@ -14,16 +14,6 @@ namespace dae
 		Vector3 viewDirection{}; //W4
 	};
 
-	struct Vertex_Out
-	{
-		Vector4 position{};
-		ColorRGB color{ colors::White };
-		Vector2 uv{};
-		Vector3 normal{};
-		Vector3 tangent{};
-		Vector3 viewDirection{};
-	};
-
 	enum class PrimitiveTopology
 	{
 		TriangleList,
@@ -35,7 +25,13 @@ namespace dae
 		std::vector<Vertex_In> vertices{};
 		std::vector<uint32_t> indices{};
 		PrimitiveTopology primitiveTopology{ PrimitiveTopology::TriangleStrip };
+	};
 
-		std::vector<Vertex_Out> vertices_out{};
+	enum RenderMode
+	{
+		ObservedArea,
+		Diffuse,
+		Specular,
+		Combined
 	};
 }
\ No newline at end of file
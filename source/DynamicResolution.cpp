@@ -0,0 +1,54 @@
+#include "pch.h"
+#include "DynamicResolution.h"
+
+namespace dae
+{
+	DynamicResolution::DynamicResolution(int maxWidth, int maxHeight, float targetFrameTime)
+		: m_MaxWidth{ maxWidth }
+		, m_MaxHeight{ maxHeight }
+		, m_Width{ maxWidth }
+		, m_Height{ maxHeight }
+		, m_TargetFrameTime{ targetFrameTime }
+		, m_SmoothedFrameTime{ targetFrameTime }
+	{
+	}
+
+	bool DynamicResolution::Update(float frameTime)
+	{
+		//Smooth out single spikes, a hitch shouldn't drop the resolution
+		m_SmoothedFrameTime += (frameTime - m_SmoothedFrameTime) * m_Smoothing;
+
+		//Give the new resolution a few frames to show up in the measurements
+		if (m_Cooldown > 0)
+		{
+			--m_Cooldown;
+			return false;
+		}
+
+		if (m_SmoothedFrameTime <= m_TargetFrameTime * m_OverBudget && m_SmoothedFrameTime >= m_TargetFrameTime * m_UnderBudget)
+			return false;
+
+		const float targetScale{ m_Scale * sqrtf(m_TargetFrameTime / std::max(m_SmoothedFrameTime, 0.0001f)) };
+		const float scale{ Clamp(m_Scale + (targetScale - m_Scale) * 0.5f, m_MinScale, m_MaxScale) };
+
+		//Snap the width so small corrections don't change the resolution every frame
+		const int width{ Clamp(static_cast<int>(static_cast<float>(m_MaxWidth) * scale / m_Granularity + 0.5f) * m_Granularity, m_Granularity, m_MaxWidth) };
+		if (width == m_Width)
+			return false;
+
+		m_Width = width;
+		m_Scale = static_cast<float>(m_Width) / static_cast<float>(m_MaxWidth);
+		m_Height = std::min(static_cast<int>(static_cast<float>(m_MaxHeight) * m_Scale + 0.5f), m_MaxHeight);
+		m_Cooldown = m_CooldownFrames;
+		return true;
+	}
+
+	void DynamicResolution::Reset()
+	{
+		m_Width = m_MaxWidth;
+		m_Height = m_MaxHeight;
+		m_Scale = m_MaxScale;
+		m_SmoothedFrameTime = m_TargetFrameTime;
+		m_Cooldown = 0;
+	}
+}
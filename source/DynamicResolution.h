@@ -0,0 +1,40 @@
+#pragma once
+
+namespace dae
+{
+	//Picks the software render resolution from measured frame times to hold a frame budget.
+	//Pixel cost scales with area, so the scale moves with the square root of the budget ratio.
+	class DynamicResolution final
+	{
+	public:
+		DynamicResolution(int maxWidth, int maxHeight, float targetFrameTime = 1.f / 60.f);
+
+		//Feeds the last frame time, returns true when the render resolution changed
+		bool Update(float frameTime);
+		void Reset();
+
+		int GetWidth() const { return m_Width; }
+		int GetHeight() const { return m_Height; }
+		float GetScale() const { return m_Scale; }
+		float GetTargetFrameTime() const { return m_TargetFrameTime; }
+
+	private:
+		static constexpr float m_MinScale{ 0.5f };
+		static constexpr float m_MaxScale{ 1.f };
+		static constexpr float m_Smoothing{ 0.1f };
+		static constexpr float m_OverBudget{ 1.05f };
+		static constexpr float m_UnderBudget{ 0.85f };
+		static constexpr int m_Granularity{ 8 };
+		static constexpr int m_CooldownFrames{ 15 };
+
+		int m_MaxWidth{};
+		int m_MaxHeight{};
+		int m_Width{};
+		int m_Height{};
+
+		float m_TargetFrameTime{};
+		float m_SmoothedFrameTime{};
+		float m_Scale{ m_MaxScale };
+		int m_Cooldown{};
+	};
+}
@@ -16,6 +16,23 @@ Effect::Effect(ID3D11Device* pDevice, const std::wstring& assetFile)
 	{
 		std::wcout << L"Technique not valid!\n";
 	}
+	m_pQuantizedTechnique = m_pEffect->GetTechniqueByName("QuantizedTechnique");
+	if (!m_pQuantizedTechnique->IsValid())
+	{
+		std::wcout << L"Quantized technique not valid!\n";
+	}
+
+	//Quantized vertices
+	m_pPositionOffsetVariable = m_pEffect->GetVariableByName("gPositionOffset")->AsVector();
+	if (!m_pPositionOffsetVariable->IsValid())
+	{
+		std::wcout << L"m_pPositionOffsetVariable not valid!\n";
+	}
+	m_pPositionScaleVariable = m_pEffect->GetVariableByName("gPositionScale")->AsVector();
+	if (!m_pPositionScaleVariable->IsValid())
+	{
+		std::wcout << L"m_pPositionScaleVariable not valid!\n";
+	}
 
 	//Matrices
 	m_pMatWorldViewProjVariable = m_pEffect->GetVariableByName("gWorldViewProj")->AsMatrix();
@@ -63,6 +80,18 @@ Effect::~Effect()
 	{
 		m_pTechnique->Release();
 	}
+	if (m_pQuantizedTechnique)
+	{
+		m_pQuantizedTechnique->Release();
+	}
+	if (m_pPositionOffsetVariable)
+	{
+		m_pPositionOffsetVariable->Release();
+	}
+	if (m_pPositionScaleVariable)
+	{
+		m_pPositionScaleVariable->Release();
+	}
 
 	//Matrices
 	if (m_pMatViewInvVariable)
@@ -183,4 +212,9 @@ void Effect::SetMatrixWorld(const dae::Matrix& matrix) const
 void Effect::SetMatrixViewInv(const dae::Matrix& matrix) const
 {
 	m_pMatViewInvVariable->SetMatrix(reinterpret_cast<const float*>(&matrix));
-}
\ No newline at end of file
+}
+void Effect::SetPositionDequantization(const dae::Vector3& offset, const dae::Vector3& scale) const
+{
+	m_pPositionOffsetVariable->SetFloatVector(reinterpret_cast<const float*>(&offset));
+	m_pPositionScaleVariable->SetFloatVector(reinterpret_cast<const float*>(&scale));
+}
@@ -28,6 +28,11 @@ public:
 	{
 		return m_pTechnique;
 	}
+	ID3DX11EffectTechnique* GetQuantizedTechnique() const
+	{
+		return m_pQuantizedTechnique;
+	}
+	void SetPositionDequantization(const dae::Vector3& offset, const dae::Vector3& scale) const;
 	void SetMatrixViewProj(const dae::Matrix& matrix) const;
 	void SetMatrixWorld(const dae::Matrix& matrix) const;
 	void SetMatrixViewInv(const dae::Matrix& matrix) const;
@@ -36,6 +41,11 @@ private:
 
 	ID3DX11Effect* m_pEffect{};
 	ID3DX11EffectTechnique* m_pTechnique{};
+	ID3DX11EffectTechnique* m_pQuantizedTechnique{};
+
+	//Quantized vertices
+	ID3DX11EffectVectorVariable* m_pPositionOffsetVariable{};
+	ID3DX11EffectVectorVariable* m_pPositionScaleVariable{};
 
 	//Matrices
 	ID3DX11EffectMatrixVariable* m_pMatWorldViewProjVariable{};
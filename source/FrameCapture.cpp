@@ -0,0 +1,175 @@
+#include "pch.h"
+#include "FrameCapture.h"
+#include "Profiler.h"
+
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+namespace dae
+{
+	namespace
+	{
+		bool HasExtension(const std::string& path, const char* pExtension)
+		{
+			const size_t length{ std::strlen(pExtension) };
+			if (path.size() < length)
+				return false;
+
+			return std::equal(path.end() - static_cast<ptrdiff_t>(length), path.end(), pExtension, [](char a, char b)
+				{
+					return std::tolower(static_cast<unsigned char>(a)) == b;
+				});
+		}
+	}
+
+	FrameCapture::FrameCapture(size_t maxStagingBuffers)
+		: m_MaxStagingBuffers{ std::max<size_t>(maxStagingBuffers, 1) }
+		, m_EncodeThread{ &FrameCapture::EncodeLoop, this }
+	{
+	}
+
+	FrameCapture::~FrameCapture()
+	{
+		{
+			const std::lock_guard lock{ m_Mutex };
+			m_IsStopping = true;
+		}
+		m_QueueChanged.notify_all();
+		m_EncodeThread.join();
+	}
+
+	bool FrameCapture::Submit(const uint32_t* pPixels, int width, int height, int pitch, const SDL_PixelFormat* pFormat, std::string path)
+	{
+		PROFILE_ZONE("FrameCapture::Submit");
+
+		StagingBuffer* pBuffer{ nullptr };
+		{
+			const std::lock_guard lock{ m_Mutex };
+			if (!m_pFreeBuffers.empty())
+			{
+				pBuffer = m_pFreeBuffers.back();
+				m_pFreeBuffers.pop_back();
+			}
+			else if (m_pStagingBuffers.size() < m_MaxStagingBuffers)
+			{
+				m_pStagingBuffers.push_back(std::make_unique<StagingBuffer>());
+				pBuffer = m_pStagingBuffers.back().get();
+			}
+			else
+			{
+				//The encoder is behind, the render loop doesn't wait for it
+				++m_NrDropped;
+				return false;
+			}
+		}
+
+		//Only this thread owns the buffer until it is queued, the copy happens outside the lock
+		pBuffer->pixels.resize(static_cast<size_t>(width) * height);
+		for (int y{}; y < height; ++y)
+		{
+			std::copy_n(pPixels + static_cast<ptrdiff_t>(y) * pitch, width, pBuffer->pixels.data() + static_cast<ptrdiff_t>(y) * width);
+		}
+		pBuffer->width = width;
+		pBuffer->height = height;
+		pBuffer->redShift = pFormat->Rshift;
+		pBuffer->greenShift = pFormat->Gshift;
+		pBuffer->blueShift = pFormat->Bshift;
+		pBuffer->path = std::move(path);
+
+		{
+			const std::lock_guard lock{ m_Mutex };
+			m_pQueuedBuffers.push_back(pBuffer);
+		}
+		m_QueueChanged.notify_all();
+		return true;
+	}
+
+	void FrameCapture::Flush()
+	{
+		std::unique_lock lock{ m_Mutex };
+		m_QueueChanged.wait(lock, [this] { return m_pQueuedBuffers.empty() && !m_IsEncoding; });
+	}
+
+	uint32_t FrameCapture::GetNrWritten() const
+	{
+		const std::lock_guard lock{ m_Mutex };
+		return m_NrWritten;
+	}
+
+	uint32_t FrameCapture::GetNrDropped() const
+	{
+		const std::lock_guard lock{ m_Mutex };
+		return m_NrDropped;
+	}
+
+	uint32_t FrameCapture::GetNrFailed() const
+	{
+		const std::lock_guard lock{ m_Mutex };
+		return m_NrFailed;
+	}
+
+	void FrameCapture::EncodeLoop()
+	{
+		Profiler::SetThreadName("FrameCapture");
+
+		std::unique_lock lock{ m_Mutex };
+		while (true)
+		{
+			//Stopping still drains the queue, a capture that was accepted is always written
+			m_QueueChanged.wait(lock, [this] { return m_IsStopping || !m_pQueuedBuffers.empty(); });
+			if (m_pQueuedBuffers.empty())
+				return;
+
+			StagingBuffer* pBuffer{ m_pQueuedBuffers.front() };
+			m_pQueuedBuffers.pop_front();
+			m_IsEncoding = true;
+
+			lock.unlock();
+			const bool isWritten{ Write(*pBuffer) };
+			lock.lock();
+
+			++(isWritten ? m_NrWritten : m_NrFailed);
+			m_pFreeBuffers.push_back(pBuffer);
+			m_IsEncoding = false;
+			m_QueueChanged.notify_all();
+		}
+	}
+
+	bool FrameCapture::Write(const StagingBuffer& buffer)
+	{
+		PROFILE_ZONE("FrameCapture::Write");
+
+		//Tightly packed 8 bit RGB, both encoders take it as is
+		const size_t nrPixels{ buffer.pixels.size() };
+		m_Rgb.resize(nrPixels * 3);
+		for (size_t i{}; i < nrPixels; ++i)
+		{
+			const uint32_t pixel{ buffer.pixels[i] };
+			m_Rgb[i * 3 + 0] = static_cast<uint8_t>(pixel >> buffer.redShift);
+			m_Rgb[i * 3 + 1] = static_cast<uint8_t>(pixel >> buffer.greenShift);
+			m_Rgb[i * 3 + 2] = static_cast<uint8_t>(pixel >> buffer.blueShift);
+		}
+
+		if (HasExtension(buffer.path, ".ppm"))
+		{
+			std::ofstream file{ buffer.path, std::ios::binary | std::ios::trunc };
+			if (!file)
+				return false;
+
+			file << "P6\n" << buffer.width << ' ' << buffer.height << "\n255\n";
+			file.write(reinterpret_cast<const char*>(m_Rgb.data()), static_cast<std::streamsize>(m_Rgb.size()));
+			return static_cast<bool>(file);
+		}
+
+		//Byte order masks, the surface only wraps the converted pixels
+		SDL_Surface* pSurface{ SDL_CreateRGBSurfaceFrom(m_Rgb.data(), buffer.width, buffer.height, 24, buffer.width * 3,
+			SDL_BYTEORDER == SDL_LIL_ENDIAN ? 0x0000FF : 0xFF0000, 0x00FF00, SDL_BYTEORDER == SDL_LIL_ENDIAN ? 0xFF0000 : 0x0000FF, 0) };
+		if (!pSurface)
+			return false;
+
+		const bool isWritten{ IMG_SavePNG(pSurface, buffer.path.c_str()) == 0 };
+		SDL_FreeSurface(pSurface);
+		return isWritten;
+	}
+}
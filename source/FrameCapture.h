@@ -0,0 +1,75 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct SDL_PixelFormat;
+
+namespace dae
+{
+	//Frame capture off the render thread. Submit only copies the pixels into a staging buffer,
+	//a background thread encodes and writes them, PNG or binary PPM picked by the extension of the path.
+	//Staging buffers are allocated on first use and reused, when all of them are still queued the capture is dropped instead of waiting.
+	class FrameCapture final
+	{
+	public:
+		explicit FrameCapture(size_t maxStagingBuffers = 4);
+		//Writes every capture that is still queued
+		~FrameCapture();
+
+		FrameCapture(const FrameCapture&) = delete;
+		FrameCapture(FrameCapture&&) noexcept = delete;
+		FrameCapture& operator=(const FrameCapture&) = delete;
+		FrameCapture& operator=(FrameCapture&&) noexcept = delete;
+
+		//pitch in pixels, returns false when the capture was dropped
+		bool Submit(const uint32_t* pPixels, int width, int height, int pitch, const SDL_PixelFormat* pFormat, std::string path);
+		//Blocks until the queue is empty, for the end of a run, never per frame
+		void Flush();
+
+		uint32_t GetNrWritten() const;
+		uint32_t GetNrDropped() const;
+		uint32_t GetNrFailed() const;
+
+	private:
+		//Raw copy of the surface rows, the conversion to RGB happens on the encode thread
+		struct StagingBuffer
+		{
+			std::vector<uint32_t> pixels{};
+			int width{};
+			int height{};
+			uint8_t redShift{};
+			uint8_t greenShift{};
+			uint8_t blueShift{};
+			std::string path{};
+		};
+
+		const size_t m_MaxStagingBuffers;
+		std::vector<std::unique_ptr<StagingBuffer>> m_pStagingBuffers{};
+		std::vector<StagingBuffer*> m_pFreeBuffers{};
+		std::deque<StagingBuffer*> m_pQueuedBuffers{};
+
+		mutable std::mutex m_Mutex{};
+		std::condition_variable m_QueueChanged{};
+		bool m_IsEncoding{ false };
+		bool m_IsStopping{ false };
+
+		uint32_t m_NrWritten{};
+		uint32_t m_NrDropped{};
+		uint32_t m_NrFailed{};
+
+		//Only touched by the encode thread
+		std::vector<uint8_t> m_Rgb{};
+
+		//Last member, it starts running in the constructor
+		std::thread m_EncodeThread{};
+
+		void EncodeLoop();
+		bool Write(const StagingBuffer& buffer);
+	};
+}
@@ -0,0 +1,118 @@
+#include "pch.h"
+#include "FrameHistory.h"
+
+#include <fstream>
+
+namespace dae
+{
+	namespace
+	{
+		//Nearest rank percentile of a sorted window
+		uint64_t GetPercentile(const std::vector<uint64_t>& sorted, size_t percentile)
+		{
+			const size_t rank{ (sorted.size() * percentile + 99) / 100 };
+			return sorted[std::max<size_t>(rank, 1) - 1];
+		}
+
+		void WriteStats(std::ofstream& file, const FrameStats& stats)
+		{
+			file << "{ \"frames\": " << stats.nrFrames
+				<< ", \"minNs\": " << stats.minNs
+				<< ", \"avgNs\": " << stats.avgNs
+				<< ", \"p50Ns\": " << stats.p50Ns
+				<< ", \"p95Ns\": " << stats.p95Ns
+				<< ", \"p99Ns\": " << stats.p99Ns
+				<< ", \"maxNs\": " << stats.maxNs
+				<< ", \"stutters\": " << stats.nrStutters << " }";
+		}
+	}
+
+	FrameHistory::FrameHistory(size_t capacity, float stutterFactor)
+		: m_Samples(std::max<size_t>(capacity, 1))
+		, m_StutterFactor{ stutterFactor }
+	{
+	}
+
+	void FrameHistory::Add(uint64_t timestampNs, uint64_t frameTimeNs)
+	{
+		m_Samples[m_Next] = { timestampNs, frameTimeNs };
+		m_Next = (m_Next + 1) % m_Samples.size();
+		m_Size = std::min(m_Size + 1, m_Samples.size());
+	}
+
+	void FrameHistory::Clear()
+	{
+		m_Next = 0;
+		m_Size = 0;
+	}
+
+	const FrameHistory::Sample& FrameHistory::GetSample(size_t index) const
+	{
+		const size_t oldest{ (m_Next + m_Samples.size() - m_Size) % m_Samples.size() };
+		return m_Samples[(oldest + index) % m_Samples.size()];
+	}
+
+	FrameStats FrameHistory::Calculate(size_t nrFrames) const
+	{
+		FrameStats stats{};
+		stats.nrFrames = std::min(nrFrames, m_Size);
+		if (stats.nrFrames == 0)
+			return stats;
+
+		m_SortedFrameTimes.clear();
+		uint64_t totalNs{};
+		for (size_t i{ m_Size - stats.nrFrames }; i < m_Size; ++i)
+		{
+			const uint64_t frameTimeNs{ GetSample(i).frameTimeNs };
+			m_SortedFrameTimes.push_back(frameTimeNs);
+			totalNs += frameTimeNs;
+		}
+		std::sort(m_SortedFrameTimes.begin(), m_SortedFrameTimes.end());
+
+		stats.minNs = m_SortedFrameTimes.front();
+		stats.maxNs = m_SortedFrameTimes.back();
+		stats.avgNs = totalNs / stats.nrFrames;
+		stats.p50Ns = GetPercentile(m_SortedFrameTimes, 50);
+		stats.p95Ns = GetPercentile(m_SortedFrameTimes, 95);
+		stats.p99Ns = GetPercentile(m_SortedFrameTimes, 99);
+
+		const double stutterNs{ static_cast<double>(stats.p50Ns) * m_StutterFactor };
+		const auto firstStutter{ std::upper_bound(m_SortedFrameTimes.begin(), m_SortedFrameTimes.end(), stutterNs,
+			[](double threshold, uint64_t frameTimeNs) { return threshold < static_cast<double>(frameTimeNs); }) };
+		stats.nrStutters = static_cast<uint32_t>(m_SortedFrameTimes.end() - firstStutter);
+		return stats;
+	}
+
+	bool FrameHistory::WriteCsv(const std::string& path) const
+	{
+		std::ofstream file{ path, std::ios::trunc };
+		if (!file)
+			return false;
+
+		file << "frame,timestampNs,frameTimeNs\n";
+		for (size_t i{}; i < m_Size; ++i)
+		{
+			const Sample& sample{ GetSample(i) };
+			file << i << ',' << sample.timestampNs << ',' << sample.frameTimeNs << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+
+	bool FrameHistory::WriteJson(const std::string& path, std::span<const size_t> windows) const
+	{
+		std::ofstream file{ path, std::ios::trunc };
+		if (!file)
+			return false;
+
+		file << "{\n\t\"stutterFactor\": " << m_StutterFactor << ",\n\t\"all\": ";
+		WriteStats(file, Calculate());
+		file << ",\n\t\"windows\": [";
+		for (size_t i{}; i < windows.size(); ++i)
+		{
+			file << (i == 0 ? "\n\t\t" : ",\n\t\t");
+			WriteStats(file, Calculate(windows[i]));
+		}
+		file << "\n\t]\n}\n";
+		return static_cast<bool>(file);
+	}
+}
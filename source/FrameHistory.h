@@ -0,0 +1,65 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace dae
+{
+	//Summary of a window of frames, every time is in nanoseconds
+	struct FrameStats
+	{
+		size_t nrFrames{};
+		uint64_t minNs{};
+		uint64_t avgNs{};
+		uint64_t p50Ns{};
+		uint64_t p95Ns{};
+		uint64_t p99Ns{};
+		uint64_t maxNs{};
+
+		//Frames that took longer than the stutter factor times the median of the window
+		uint32_t nrStutters{};
+	};
+
+	//Ring buffer of the most recent frame times, older frames are overwritten once it is full.
+	//Averages hide single long frames, the percentiles and the stutter count show them.
+	class FrameHistory final
+	{
+	public:
+		explicit FrameHistory(size_t capacity = 16384, float stutterFactor = 2.f);
+
+		//Timestamp of the end of the frame, both measured from the start of the timer
+		void Add(uint64_t timestampNs, uint64_t frameTimeNs);
+		void Clear();
+
+		size_t GetSize() const { return m_Size; }
+		size_t GetCapacity() const { return m_Samples.size(); }
+
+		//Stats of the last nrFrames frames, the whole history when there are fewer
+		FrameStats Calculate(size_t nrFrames) const;
+		FrameStats Calculate() const { return Calculate(m_Size); }
+
+		//One line per frame, oldest first
+		bool WriteCsv(const std::string& path) const;
+		//Stats per window, a window larger than the history covers the whole history
+		bool WriteJson(const std::string& path, std::span<const size_t> windows) const;
+
+	private:
+		struct Sample
+		{
+			uint64_t timestampNs{};
+			uint64_t frameTimeNs{};
+		};
+
+		std::vector<Sample> m_Samples;
+		size_t m_Next{};
+		size_t m_Size{};
+		float m_StutterFactor{};
+
+		//Reused by Calculate, the percentiles need the window sorted
+		mutable std::vector<uint64_t> m_SortedFrameTimes{};
+
+		//index 0 is the oldest frame still in the buffer
+		const Sample& GetSample(size_t index) const;
+	};
+}
@@ -4,6 +4,12 @@ namespace dae
 	class HardwareMesh;
 	struct SoftwareMesh;
 
+	//Both backends keep their vertex buffers in the 20 byte QuantizedVertex format
+	constexpr bool g_UseQuantizedVertices{ true };
+
+	//Normalization and reciprocals in the software shading and interpolation, ExactPrecision for reference renders
+	using ShadingPrecision = FastPrecision;
+
 	enum CullMode
 	{
 		Back,
@@ -21,5 +27,45 @@ namespace dae
 		HardwareMesh* pHMesh{ nullptr };
 		SoftwareMesh* pSMesh{ nullptr };
 		Matrix* pWorldMatrix = new dae::Matrix{ dae::Vector3::UnitX, dae::Vector3::UnitY, dae::Vector3::UnitZ, dae::Vector3::Zero };
+
+		//Bumped on every change of the world matrix, anything derived from it compares against this
+		uint32_t worldVersion{ 1 };
+
+		void SetWorldMatrix(const Matrix& worldMatrix)
+		{
+			*pWorldMatrix = worldMatrix;
+			++worldVersion;
+		}
+
+		//World * viewProjection, only multiplied again when the world matrix or the camera changed
+		const Matrix& GetWorldViewProjection(const Matrix& viewProjectionMatrix, uint32_t viewProjectionVersion) const
+		{
+			if (cachedWorldVersion != worldVersion || cachedViewProjectionVersion != viewProjectionVersion)
+			{
+				worldViewProjectionMatrix = *pWorldMatrix * viewProjectionMatrix;
+				cachedWorldVersion = worldVersion;
+				cachedViewProjectionVersion = viewProjectionVersion;
+			}
+			return worldViewProjectionMatrix;
+		}
+
+		//Object space bounds, filled once at load by InitializeGlobalMesh
+		bool isInitialized{ false };
+		Vector3 boundsMin{};
+		Vector3 boundsMax{};
+		Vector3 boundsCenter{};
+		float boundsRadius{};
+
+		//Simplified geometry drawn into the occlusion buffer, empty when the mesh doesn't hide anything
+		std::vector<Vector3> occluderVertices{};
+		std::vector<uint32_t> occluderIndices{};
+
+		//Result of the visibility tests of this frame, both renderers skip the mesh when false
+		bool isVisible{ true };
+
+	private:
+		mutable Matrix worldViewProjectionMatrix{};
+		mutable uint32_t cachedWorldVersion{};
+		mutable uint32_t cachedViewProjectionVersion{};
 	};
 }
\ No newline at end of file
@@ -1,165 +1,26 @@
 #pragma once
-#include <fstream>
 #include "Math.h"
 #include <vector>
 #include "HardwareMesh.h"
+#include "AssetCache.h"
 
 namespace dae
 {
 	namespace Utils
 	{
-		//Just parses vertices and indices
 #pragma warning(push)
 #pragma warning(disable : 4505) //Warning unreferenced local function
-		static bool HWParseOBJ(const std::string& filename, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, bool flipAxisAndWinding = true)
+		//Hardware vertices of an imported mesh, the shader normalizes the tangents so the accumulated ones can be used as is
+		static void HWConvertMesh(const MeshData& mesh, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
 		{
-			std::ifstream file(filename);
-			if (!file)
-				return false;
-
-			std::vector<Vector3> positions{};
-			std::vector<Vector3> normals{};
-			std::vector<Vector2> UVs{};
-
 			vertices.clear();
-			indices.clear();
-
-			std::string sCommand;
-			// start a while iteration ending when the end of file is reached (ios::eof)
-			while (!file.eof())
+			vertices.reserve(mesh.vertices.size());
+			for (const MeshCache::CachedVertex& v : mesh.vertices)
 			{
-				//read the first word of the string, use the >> operator (istream::operator>>) 
-				file >> sCommand;
-				//use conditional statements to process the different commands	
-				if (sCommand == "#")
-				{
-					// Ignore Comment
-				}
-				else if (sCommand == "v")
-				{
-					//Vertex
-					float x, y, z;
-					file >> x >> y >> z;
-
-					positions.emplace_back(x, y, z);
-				}
-				else if (sCommand == "vt")
-				{
-					// Vertex TexCoord
-					float u, v;
-					file >> u >> v;
-					UVs.emplace_back(u, 1 - v);
-				}
-				else if (sCommand == "vn")
-				{
-					// Vertex Normal
-					float x, y, z;
-					file >> x >> y >> z;
-
-					normals.emplace_back(x, y, z);
-				}
-				else if (sCommand == "f")
-				{
-					//if a face is read:
-					//construct the 3 vertices, add them to the vertex array
-					//add three indices to the index array
-					//add the material index as attibute to the attribute array
-					//
-					// Faces or triangles
-					Vertex vertex{};
-					size_t iPosition, iTexCoord, iNormal;
-
-					uint32_t tempIndices[3];
-					for (unsigned int& tempIndice : tempIndices)
-					{
-						// OBJ format uses 1-based arrays
-						file >> iPosition;
-						vertex.Position = positions[iPosition - 1];
-
-						if ('/' == file.peek())//is next in buffer ==  '/' ?
-						{
-							file.ignore();//read and ignore one element ('/')
-
-							if ('/' != file.peek())
-							{
-								// Optional texture coordinate
-								file >> iTexCoord;
-								vertex.UV = UVs[iTexCoord - 1];
-							}
-
-							if ('/' == file.peek())
-							{
-								file.ignore();
-
-								// Optional vertex normal
-								file >> iNormal;
-								vertex.Normal = normals[iNormal - 1];
-							}
-						}
-
-						vertices.push_back(vertex);
-						tempIndice = static_cast<uint32_t>(vertices.size()) - 1;
-						//indices.push_back(uint32_t(vertices.size()) - 1);
-					}
-
-					indices.push_back(tempIndices[0]);
-					if (flipAxisAndWinding)
-					{
-						indices.push_back(tempIndices[2]);
-						indices.push_back(tempIndices[1]);
-					}
-					else
-					{
-						indices.push_back(tempIndices[1]);
-						indices.push_back(tempIndices[2]);
-					}
-				}
-				//read till end of line and ignore all remaining chars
-				file.ignore(1000, '\n');
-			}
-
-			//Cheap Tangent Calculations
-			for (uint32_t i = 0; i < indices.size(); i += 3)
-			{
-				uint32_t index0 = indices[i];
-				uint32_t index1 = indices[static_cast<size_t>(i) + 1];
-				uint32_t index2 = indices[static_cast<size_t>(i) + 2];
-			
-				const Vector3& p0 = vertices[index0].Position;
-				const Vector3& p1 = vertices[index1].Position;
-				const Vector3& p2 = vertices[index2].Position;
-				const Vector2& uv0 = vertices[index0].UV;
-				const Vector2& uv1 = vertices[index1].UV;
-				const Vector2& uv2 = vertices[index2].UV;
-			
-				const Vector3 edge0 = p1 - p0;
-				const Vector3 edge1 = p2 - p0;
-				const Vector2 diffX = Vector2(uv1.x - uv0.x, uv2.x - uv0.x);
-				const Vector2 diffY = Vector2(uv1.y - uv0.y, uv2.y - uv0.y);
-				float r = 1.f / Vector2::Cross(diffX, diffY);
-			
-				Vector3 tangent = (edge0 * diffY.y - edge1 * diffY.x) * r;
-				vertices[index0].Tangent += tangent;
-				vertices[index1].Tangent += tangent;
-				vertices[index2].Tangent += tangent;
-			}
-
-			//Create the Tangents (reject)
-			for (auto& v : vertices)
-			{
-				//v.tangent = Vector3::Reject(v.tangent, v.normal).Normalized();
-
-				if (flipAxisAndWinding)
-				{
-					v.Position.z *= -1.f;
-					v.Normal.z *= -1.f;
-					v.Tangent.z *= -1.f;
-				}
-
+				vertices.push_back({ v.position, v.normal, v.tangent, v.uv });
 			}
-
-			return true;
+			indices = mesh.indices;
 		}
 #pragma warning(pop)
 	}
-}
\ No newline at end of file
+}
@@ -1,34 +1,17 @@
 #include "pch.h"
 #include "HardwareMesh.h"
+#include "Camera.h"
 #include "Effect.h"
 #include "HardwareTexture.h"
 
 namespace dae
 {
-	HardwareMesh::HardwareMesh(ID3D11Device* pDevice, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const MeshDataPaths& paths, Matrix* pWorldMatrix):
+	HardwareMesh::HardwareMesh(ID3D11Device* pDevice, AssetCache& assets, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const MeshDataPaths& paths, GlobalMesh* pGlobalMesh):
 		m_pEffect{ new Effect{ pDevice, paths.effect } },
-		m_pWorldMatrix(pWorldMatrix)
+		m_VertexStride{ sizeof(Vertex) },
+		m_pGlobalMesh(pGlobalMesh)
 	{
-		///Create textures
-		
-		m_pDiffuseTexture = new HardwareTexture{ pDevice, paths.diffuse };
-		m_pEffect->SetDiffuseMap(m_pDiffuseTexture);
-
-		if (!paths.normal.empty())
-		{
-			m_pNormalTexture = new HardwareTexture{ pDevice, paths.normal };
-			m_pEffect->SetNormalMap(m_pNormalTexture);
-		}
-		if (!paths.specular.empty())
-		{
-			m_pSpecularTexture = new HardwareTexture{ pDevice, paths.specular };
-			m_pEffect->SetSpecularMap(m_pSpecularTexture);
-		}
-		if (!paths.gloss.empty())
-		{
-			m_pGlossinessTexture = new HardwareTexture{ pDevice, paths.gloss };
-			m_pEffect->SetGlossinessMap(m_pGlossinessTexture);
-		}
+		LoadTextures(pDevice, assets, paths);
 
 		//Get Technique from Effect
 		m_pTechnique = m_pEffect->GetTechnique();
@@ -57,13 +40,80 @@ namespace dae
 		vertexDesc[3].AlignedByteOffset = 36;
 		vertexDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 
+		CreateBuffers(pDevice, vertexDesc, numElements, vertices.data(), static_cast<uint32_t>(vertices.size()), indices);
+	}
+
+	HardwareMesh::HardwareMesh(ID3D11Device* pDevice, AssetCache& assets, const std::vector<QuantizedVertex>& vertices, const QuantizationBounds& bounds, const std::vector<uint32_t>& indices, const MeshDataPaths& paths, GlobalMesh* pGlobalMesh) :
+		m_pEffect{ new Effect{ pDevice, paths.effect } },
+		m_VertexStride{ sizeof(QuantizedVertex) },
+		m_pGlobalMesh(pGlobalMesh)
+	{
+		LoadTextures(pDevice, assets, paths);
+
+		//The quantized technique decodes the vertex in the vertex shader
+		m_pTechnique = m_pEffect->GetQuantizedTechnique();
+		m_pEffect->SetPositionDequantization(bounds.offset, bounds.scale);
+
+		//Create Vertex Layout
+		static constexpr uint32_t numElements{ 4 };
+		D3D11_INPUT_ELEMENT_DESC vertexDesc[numElements]{};
+
+		vertexDesc[0].SemanticName = "POSITION";
+		vertexDesc[0].Format = DXGI_FORMAT_R16G16B16A16_UNORM;
+		vertexDesc[0].AlignedByteOffset = 0;
+		vertexDesc[0].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+		vertexDesc[1].SemanticName = "NORMAL";
+		vertexDesc[1].Format = DXGI_FORMAT_R16G16_SNORM;
+		vertexDesc[1].AlignedByteOffset = 8;
+		vertexDesc[1].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+		vertexDesc[2].SemanticName = "TANGENT";
+		vertexDesc[2].Format = DXGI_FORMAT_R16G16_SNORM;
+		vertexDesc[2].AlignedByteOffset = 12;
+		vertexDesc[2].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+		vertexDesc[3].SemanticName = "TEXCOORD";
+		vertexDesc[3].Format = DXGI_FORMAT_R16G16_FLOAT;
+		vertexDesc[3].AlignedByteOffset = 16;
+		vertexDesc[3].InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+
+		CreateBuffers(pDevice, vertexDesc, numElements, vertices.data(), static_cast<uint32_t>(vertices.size()), indices);
+	}
+
+	void HardwareMesh::LoadTextures(ID3D11Device* pDevice, AssetCache& assets, const MeshDataPaths& paths)
+	{
+		///Create textures
+		
+		m_pDiffuseTexture = new HardwareTexture{ pDevice, assets.LoadSurface(paths.diffuse).get() };
+		m_pEffect->SetDiffuseMap(m_pDiffuseTexture);
+
+		if (!paths.normal.empty())
+		{
+			m_pNormalTexture = new HardwareTexture{ pDevice, assets.LoadSurface(paths.normal).get() };
+			m_pEffect->SetNormalMap(m_pNormalTexture);
+		}
+		if (!paths.specular.empty())
+		{
+			m_pSpecularTexture = new HardwareTexture{ pDevice, assets.LoadSurface(paths.specular).get() };
+			m_pEffect->SetSpecularMap(m_pSpecularTexture);
+		}
+		if (!paths.gloss.empty())
+		{
+			m_pGlossinessTexture = new HardwareTexture{ pDevice, assets.LoadSurface(paths.gloss).get() };
+			m_pEffect->SetGlossinessMap(m_pGlossinessTexture);
+		}
+	}
+
+	void HardwareMesh::CreateBuffers(ID3D11Device* pDevice, const D3D11_INPUT_ELEMENT_DESC* pVertexDesc, uint32_t numElements, const void* pVertices, uint32_t numVertices, const std::vector<uint32_t>& indices)
+	{
 		//Create Input Layout and quit if failed
 		D3DX11_PASS_DESC passDesc{};
 		m_pTechnique->GetPassByIndex(0)->GetDesc(&passDesc);
 
 		HRESULT result{
 				pDevice->CreateInputLayout(
-				vertexDesc,
+				pVertexDesc,
 				numElements,
 				passDesc.pIAInputSignature,
 				passDesc.IAInputSignatureSize,
@@ -79,13 +129,13 @@ namespace dae
 		//Create vertex buffer and quit if failed
 		D3D11_BUFFER_DESC bd{};
 		bd.Usage = D3D11_USAGE_IMMUTABLE;
-		bd.ByteWidth = sizeof(Vertex) * static_cast<uint32_t>(vertices.size());
+		bd.ByteWidth = m_VertexStride * numVertices;
 		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 		bd.CPUAccessFlags = 0;
 		bd.MiscFlags = 0;
 
 		D3D11_SUBRESOURCE_DATA initData{};
-		initData.pSysMem = vertices.data();
+		initData.pSysMem = pVertices;
 
 		result = pDevice->CreateBuffer(&bd, &initData, &m_pVertexBuffer);
 
@@ -143,7 +193,7 @@ namespace dae
 		pDeviceContext->IASetInputLayout(m_pInputLayout);
 
 		//3. Set Vertex Buffer
-		constexpr UINT stride{ sizeof(Vertex) };
+		const UINT stride{ m_VertexStride };
 		constexpr UINT offset{ 0 };
 		pDeviceContext->IASetVertexBuffers(0, 1, &m_pVertexBuffer, &stride, &offset);
 
@@ -160,11 +210,18 @@ namespace dae
 		}
 	}
 
-	void HardwareMesh::SetMatrices(const Matrix& viewProj, const Matrix& invView) const
+	void HardwareMesh::SetMatrices(const Camera& camera) const
 	{
-		m_pEffect->SetMatrixWorld(*m_pWorldMatrix);
-		m_pEffect->SetMatrixViewProj(*m_pWorldMatrix * viewProj);
-		m_pEffect->SetMatrixViewInv(invView);
+		//Every mesh has its own effect, the uploaded values stay until they change
+		if (m_UploadedWorldVersion == m_pGlobalMesh->worldVersion && m_UploadedViewProjectionVersion == camera.viewProjectionVersion)
+			return;
+
+		m_pEffect->SetMatrixWorld(*m_pGlobalMesh->pWorldMatrix);
+		m_pEffect->SetMatrixViewProj(m_pGlobalMesh->GetWorldViewProjection(camera.viewProjectionMatrix, camera.viewProjectionVersion));
+		m_pEffect->SetMatrixViewInv(camera.invViewMatrix);
+
+		m_UploadedWorldVersion = m_pGlobalMesh->worldVersion;
+		m_UploadedViewProjectionVersion = camera.viewProjectionVersion;
 	}
 
 	ID3DX11EffectSamplerVariable* HardwareMesh::GetSampleVar() const
@@ -1,11 +1,16 @@
 #pragma once
 #include "pch.h"
+#include "AssetCache.h"
+#include "GlobalDefinitions.h"
+#include "QuantizedVertex.h"
 
 class Effect;
 class HardwareTexture;
 
 namespace dae
 {
+	struct Camera;
+
 	struct Vertex
 	{
 		Vector3 Position;
@@ -35,7 +40,8 @@ namespace dae
 	{
 	public:
 
-		explicit HardwareMesh(ID3D11Device* pDevice, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const MeshDataPaths& paths, Matrix* pWorldMatrix);
+		explicit HardwareMesh(ID3D11Device* pDevice, AssetCache& assets, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const MeshDataPaths& paths, GlobalMesh* pGlobalMesh);
+		explicit HardwareMesh(ID3D11Device* pDevice, AssetCache& assets, const std::vector<QuantizedVertex>& vertices, const QuantizationBounds& bounds, const std::vector<uint32_t>& indices, const MeshDataPaths& paths, GlobalMesh* pGlobalMesh);
 		~HardwareMesh();
 
 		HardwareMesh(const HardwareMesh&) = delete;
@@ -45,11 +51,12 @@ namespace dae
 
 		void Render(ID3D11DeviceContext* pDeviceContext) const;
 
-		void SetMatrices(const Matrix& viewProj, const Matrix& invView) const;
+		//Only uploads when the world matrix or the camera changed since the last upload
+		void SetMatrices(const Camera& camera) const;
 
 		void RotateY(float rotation) const
 		{
-			*m_pWorldMatrix = Matrix::CreateRotationY(rotation) * *m_pWorldMatrix;
+			m_pGlobalMesh->SetWorldMatrix(Matrix::CreateRotationY(rotation) * *m_pGlobalMesh->pWorldMatrix);
 		}
 
 		ID3DX11EffectSamplerVariable* GetSampleVar() const;
@@ -68,7 +75,13 @@ namespace dae
 		ID3D11Buffer* m_pIndexBuffer{};
 
 		uint32_t m_NumIndices{};
+		uint32_t m_VertexStride{};
+
+		GlobalMesh* m_pGlobalMesh;
+		mutable uint32_t m_UploadedWorldVersion{};
+		mutable uint32_t m_UploadedViewProjectionVersion{};
 
-		Matrix* m_pWorldMatrix;
+		void LoadTextures(ID3D11Device* pDevice, AssetCache& assets, const MeshDataPaths& paths);
+		void CreateBuffers(ID3D11Device* pDevice, const D3D11_INPUT_ELEMENT_DESC* pVertexDesc, uint32_t numElements, const void* pVertices, uint32_t numVertices, const std::vector<uint32_t>& indices);
 	};
 }
\ No newline at end of file
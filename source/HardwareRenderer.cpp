@@ -1,16 +1,41 @@
 #include "pch.h"
 #include "HardwareRenderer.h"
+#include "OcclusionBuffer.h"
+#include "Profiler.h"
 #include <future>
 
 #define DEBUG
 
 namespace dae {
+	namespace
+	{
+		//Picks the vertex format from g_UseQuantizedVertices, quantized meshes are encoded in the bounding box of the global mesh
+		HardwareMesh* CreateHardwareMesh(ID3D11Device* pDevice, AssetCache& assets, const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const MeshDataPaths& paths, GlobalMesh* pGlobalMesh)
+		{
+			if constexpr (!g_UseQuantizedVertices)
+			{
+				return new HardwareMesh{ pDevice, assets, vertices, indices, paths, pGlobalMesh };
+			}
+
+			const QuantizationBounds bounds{ Quantization::CalculateBounds(pGlobalMesh->boundsMin, pGlobalMesh->boundsMax) };
+
+			std::vector<QuantizedVertex> quantizedVertices{};
+			quantizedVertices.reserve(vertices.size());
+			for (const Vertex& vertex : vertices)
+			{
+				quantizedVertices.push_back(Quantization::Encode(vertex.Position, vertex.Normal, vertex.Tangent, vertex.UV, bounds));
+			}
+
+			return new HardwareMesh{ pDevice, assets, quantizedVertices, bounds, indices, paths, pGlobalMesh };
+		}
+	}
 
-	HardwareRenderer::HardwareRenderer(SDL_Window* pWindow, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode) :
+	HardwareRenderer::HardwareRenderer(SDL_Window* pWindow, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode, AssetCache* pAssetCache) :
 		m_pWindow(pWindow),
 		m_pCullMode(pCullMode),
 		m_pGlobalMeshes(pGlobalMeshes),
-		m_pCamera(pCamera)
+		m_pCamera(pCamera),
+		m_pAssetCache(pAssetCache)
 	{
 		//Initialize
 		SDL_GetWindowSize(pWindow, &m_Width, &m_Height);
@@ -102,6 +127,8 @@ namespace dae {
 
 	void HardwareRenderer::Update(const Timer* pTimer) const
 	{
+		PROFILE_ZONE("Hardware::Update");
+
 		constexpr float rotateSpeed{ 45.0f };
 
 		for (const auto pMesh : m_pMeshes)
@@ -111,7 +138,7 @@ namespace dae {
 				pMesh->RotateY(rotateSpeed * TO_RADIANS * pTimer->GetElapsed());
 			}
 
-			pMesh->SetMatrices(m_pCamera->viewMatrix * m_pCamera->projectionMatrix, m_pCamera->invViewMatrix);
+			pMesh->SetMatrices(*m_pCamera);
 		}
 	}
 
@@ -121,6 +148,8 @@ namespace dae {
 		if (!m_IsInitialized)
 			return;
 
+		PROFILE_ZONE("Hardware::Render");
+
 		//Clear window for next frame
 		ColorRGB clearColor{ 0.39f, 0.59f, 0.93f, 1.f };
 		if (m_ClearColor)
@@ -132,18 +161,25 @@ namespace dae {
 		m_pDeviceContext->ClearDepthStencilView(m_pDepthStencilView, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
 
 		//Set pipeline + invoke drawcalls (= render)
-		const int size = static_cast<int>(m_pMeshes.size());
-		for (int i{}; i < size; ++i)
 		{
-			if (m_ShowFireMesh == false && i > 0)
+			PROFILE_ZONE("Hardware::Draw");
+			const int size = static_cast<int>(m_pMeshes.size());
+			for (int i{}; i < size; ++i)
 			{
-				break;
+				if (m_ShowFireMesh == false && i > 0)
+				{
+					break;
+				}
+				if (!m_pGlobalMeshes[i]->isVisible || !m_pCamera->IsInFrustum(*m_pGlobalMeshes[i]))
+				{
+					continue;
+				}
+				m_pMeshes[i]->Render(m_pDeviceContext);
 			}
-			m_pMeshes[i]->Render(m_pDeviceContext);
 		}
-		
 
-		//Present to screen
+		//Present to screen, this is where the CPU waits on the GPU
+		PROFILE_ZONE("Hardware::Present");
 		m_pSwapChain->Present(0, 0);
 	}
 
@@ -361,8 +397,12 @@ namespace dae {
 		std::vector<Vertex> vertices{};
 		std::vector<uint32_t> indices{};
 
-		//Load main mesh
-		Utils::HWParseOBJ("Resources/vehicle.obj", vertices, indices);
+		//Load main mesh, the bounds and occluder are shared with the software renderer
+		if (const std::shared_ptr<const MeshData> pMeshData{ m_pAssetCache->LoadMesh("Resources/vehicle.obj") })
+		{
+			InitializeGlobalMesh(*m_pGlobalMeshes[0], *pMeshData, true);
+			Utils::HWConvertMesh(*pMeshData, vertices, indices);
+		}
 
 		MeshDataPaths paths;
 		paths.effect = L"Resources/Vehicle.fx";
@@ -370,7 +410,7 @@ namespace dae {
 		paths.normal = "Resources/vehicle_normal.png";
 		paths.specular = "Resources/vehicle_specular.png";
 		paths.gloss = "Resources/vehicle_gloss.png";
-		auto mesh = new HardwareMesh{ m_pDevice, vertices, indices, paths, m_pGlobalMeshes[0]->pWorldMatrix };
+		auto mesh = CreateHardwareMesh(m_pDevice, *m_pAssetCache, vertices, indices, paths, m_pGlobalMeshes[0]);
 		m_pGlobalMeshes[0]->pHMesh = mesh;
 		m_pMeshes.push_back(mesh);
 
@@ -381,8 +421,16 @@ namespace dae {
 		//Load fire mesh
 		paths.effect = L"Resources/Fire.fx";
 		paths.diffuse = "Resources/fireFX_diffuse.png";
-		Utils::HWParseOBJ("Resources/fireFX.obj", vertices, indices);
-		mesh = new HardwareMesh{ m_pDevice, vertices, indices, paths, m_pGlobalMeshes[1]->pWorldMatrix };
+		//Blended in triangle order, same import as the software renderer so the asset is shared
+		MeshImportOptions fireOptions{};
+		fireOptions.keepTriangleOrder = true;
+		if (const std::shared_ptr<const MeshData> pMeshData{ m_pAssetCache->LoadMesh("Resources/fireFX.obj", fireOptions) })
+		{
+			//Transparent, no occluder
+			InitializeGlobalMesh(*m_pGlobalMeshes[1], *pMeshData, false);
+			Utils::HWConvertMesh(*pMeshData, vertices, indices);
+		}
+		mesh = CreateHardwareMesh(m_pDevice, *m_pAssetCache, vertices, indices, paths, m_pGlobalMeshes[1]);
 		m_pGlobalMeshes[1]->pHMesh = mesh;
 		m_pMeshes.push_back(mesh);
 	}
@@ -18,7 +18,7 @@ namespace dae
 	class HardwareRenderer final
 	{
 	public:
-		HardwareRenderer(SDL_Window* pWindow, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode);
+		HardwareRenderer(SDL_Window* pWindow, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode, AssetCache* pAssetCache);
 		~HardwareRenderer();
 
 		void ToggleRotation() { m_Rotate = !m_Rotate; }
@@ -88,6 +88,7 @@ namespace dae
 		std::vector<GlobalMesh*>& m_pGlobalMeshes;
 		std::vector<HardwareMesh*> m_pMeshes{};
 		Camera* m_pCamera{};
+		AssetCache* m_pAssetCache{};
 
 		void CreateMesh();
 	};
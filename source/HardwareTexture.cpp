@@ -1,11 +1,8 @@
 #include "pch.h"
 #include "HardwareTexture.h"
 
-HardwareTexture::HardwareTexture(ID3D11Device* pDevice, const std::string& path)
+HardwareTexture::HardwareTexture(ID3D11Device* pDevice, const SDL_Surface* pSurface)
 {
-	//Load texture image
-	SDL_Surface* pSurface = IMG_Load(path.c_str());
-
 	//Set texture settings for directX
 	constexpr DXGI_FORMAT format{ DXGI_FORMAT_R8G8B8A8_UNORM };
 	D3D11_TEXTURE2D_DESC desc{};
@@ -40,14 +37,7 @@ HardwareTexture::HardwareTexture(ID3D11Device* pDevice, const std::string& path)
 	SRVDesc.Texture2D.MipLevels = 1;
 
 	//Create the shader resource view on GPU
-	hr = pDevice->CreateShaderResourceView(m_pTexture2D, &SRVDesc, &m_pSRV);
-	if (FAILED(hr))
-	{
-		return;
-	}
-
-	//Release sdl surface
-	SDL_FreeSurface(pSurface);
+	pDevice->CreateShaderResourceView(m_pTexture2D, &SRVDesc, &m_pSRV);
 }
 
 HardwareTexture::~HardwareTexture()
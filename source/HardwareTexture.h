@@ -2,7 +2,7 @@
 class HardwareTexture final
 {
 public:
-	HardwareTexture(ID3D11Device* pDevice, const std::string& path);
+	HardwareTexture(ID3D11Device* pDevice, const SDL_Surface* pSurface);
 	~HardwareTexture();
 
 	ID3D11Texture2D* GetTexture2D() const;
@@ -0,0 +1,255 @@
+#include "pch.h"
+#include "HeadlessBenchmark.h"
+#include "BenchmarkUtils.h"
+#include "HeadlessScene.h"
+#include "FrameHistory.h"
+#include "Profiler.h"
+
+namespace dae
+{
+	namespace HeadlessBenchmark
+	{
+		namespace
+		{
+			bool ParseRenderMode(const std::string& text, RenderMode& renderMode)
+			{
+				if (text == "combined") { renderMode = Combined; return true; }
+				if (text == "observed") { renderMode = ObservedArea; return true; }
+				if (text == "diffuse") { renderMode = Diffuse; return true; }
+				if (text == "specular") { renderMode = Specular; return true; }
+				return false;
+			}
+
+			bool ParseCullMode(const std::string& text, CullMode& cullMode)
+			{
+				if (text == "back") { cullMode = Back; return true; }
+				if (text == "front") { cullMode = Front; return true; }
+				if (text == "none") { cullMode = None; return true; }
+				return false;
+			}
+
+			const char* GetRenderModeName(RenderMode renderMode)
+			{
+				switch (renderMode)
+				{
+				case ObservedArea: return "observed";
+				case Diffuse: return "diffuse";
+				case Specular: return "specular";
+				default: return "combined";
+				}
+			}
+
+			const char* GetCullModeName(CullMode cullMode)
+			{
+				switch (cullMode)
+				{
+				case Front: return "front";
+				case None: return "none";
+				default: return "back";
+				}
+			}
+
+			//Slow dolly towards the vehicle with a sideways sway, only depends on the time so every run is the same
+			void UpdateCamera(Camera& camera, float time)
+			{
+				camera.origin = { 3.f * sinf(0.4f * time), 1.f * sinf(0.7f * time), 12.f * (0.5f - 0.5f * cosf(0.3f * time)) };
+				camera.totalYaw = -0.05f * sinf(0.4f * time);
+				camera.totalPitch = 0.f;
+				camera.UpdateMatrices();
+			}
+		}
+
+		bool IsRequested(int argc, char* args[])
+		{
+			return Utils::HasArgument(argc, args, "--headless");
+		}
+
+		bool ParseArguments(int argc, char* args[], HeadlessOptions& options, std::string& error)
+		{
+			SoftwareRenderSettings& settings{ options.settings };
+			Utils::ArgumentReader arguments{ argc, args, error };
+			while (arguments.Next())
+			{
+				const std::string& argument{ arguments.GetCurrent() };
+				if (argument == "--headless")
+					continue;
+
+				//Options with a value
+				std::string value{};
+				if (argument == "--width") { if (!arguments.TakeInt(1, options.width)) return false; }
+				else if (argument == "--height") { if (!arguments.TakeInt(1, options.height)) return false; }
+				else if (argument == "--frames") { if (!arguments.TakeInt(1, options.nrFrames)) return false; }
+				else if (argument == "--warmup") { if (!arguments.TakeInt(0, options.nrWarmupFrames)) return false; }
+				else if (argument == "--lights") { if (!arguments.TakeInt(0, options.nrLights)) return false; }
+				else if (argument == "--capture-every") { if (!arguments.TakeInt(1, options.captureInterval)) return false; }
+				else if (argument == "--capture-format")
+				{
+					arguments.TakeValue(value);
+					if (value != "png" && value != "ppm")
+					{
+						error = "--capture-format needs png or ppm";
+						return false;
+					}
+					options.captureExtension = "." + value;
+				}
+				else if (argument == "--mode")
+				{
+					arguments.TakeValue(value);
+					if (!ParseRenderMode(value, settings.renderMode))
+					{
+						error = "--mode needs combined, observed, diffuse or specular";
+						return false;
+					}
+				}
+				else if (argument == "--cull")
+				{
+					arguments.TakeValue(value);
+					if (!ParseCullMode(value, options.cullMode))
+					{
+						error = "--cull needs back, front or none";
+						return false;
+					}
+				}
+				else if (argument == "--csv") { if (!arguments.TakeValue(options.csvPath, "a path")) return false; }
+				else if (argument == "--json") { if (!arguments.TakeValue(options.jsonPath, "a path")) return false; }
+				else if (argument == "--image") { if (!arguments.TakeValue(options.imagePath, "a path")) return false; }
+				else if (argument == "--capture-path") { if (!arguments.TakeValue(options.capturePathPrefix, "a path")) return false; }
+				//Toggles, named after the interactive keys
+				else if (argument == "--msaa") { settings.isMultisampled = true; }
+				else if (argument == "--vrs") { settings.isVariableRateShading = true; }
+				else if (argument == "--dynamic-resolution") { settings.isDynamicResolution = true; }
+				else if (argument == "--depth-buffer") { settings.isDepthBuffer = true; }
+				else if (argument == "--bounding-box") { settings.isBoundingBox = true; }
+				else if (argument == "--no-normal-map") { settings.isNormal = false; }
+				else if (argument == "--no-fire") { settings.showFireMesh = false; }
+				else if (argument == "--no-rotation") { settings.isRotating = false; }
+				else if (argument == "--no-meshlet-culling") { settings.isMeshletCulling = false; }
+				else if (argument == "--no-occlusion-culling") { options.isOcclusionCulling = false; }
+				else
+				{
+					return arguments.SetUnknown();
+				}
+			}
+			return true;
+		}
+
+		void PrintUsage()
+		{
+			std::cerr << "Usage: DirectX --headless [options]\n"
+				<< "  --width N, --height N       render resolution (640x480)\n"
+				<< "  --frames N, --warmup N      timed and untimed frames (600, 30)\n"
+				<< "  --mode M                    combined, observed, diffuse or specular\n"
+				<< "  --cull C                    back, front or none\n"
+				<< "  --lights N                  point lights around the vehicle (0)\n"
+				<< "  --msaa, --vrs, --dynamic-resolution, --depth-buffer, --bounding-box\n"
+				<< "  --no-normal-map, --no-fire, --no-rotation, --no-meshlet-culling, --no-occlusion-culling\n"
+				<< "  --csv PATH                  one line per timed frame\n"
+				<< "  --json PATH                 stats of the whole run and of the last 60/600/3600 frames\n"
+				<< "  --image PATH                last frame as BMP\n"
+				<< "  --capture-every N           every Nth timed frame as an image, encoded off the render thread\n"
+				<< "  --capture-path PREFIX       file name before the frame number (Capture_)\n"
+				<< "  --capture-format F          png or ppm\n";
+		}
+
+		int Run(const HeadlessOptions& options)
+		{
+			HeadlessScene scene{ options.width, options.height };
+			scene.ApplySettings(options.settings);
+			scene.SetCullMode(options.cullMode);
+			scene.AddLights(options.nrLights);
+			scene.GetOcclusionBuffer().SetEnabled(options.isOcclusionCulling);
+			SoftwareRenderer& renderer{ scene.GetRenderer() };
+
+			//Timed from the scripted update up to the finished frame in memory, like a frame of the interactive loop
+			FrameHistory frameHistory{ static_cast<size_t>(options.nrFrames) };
+			const uint64_t startNs{ Profiler::GetTimestampNs() };
+			float previousFrameSec{ options.frameStepSec };
+
+			const int nrTotalFrames{ options.nrWarmupFrames + options.nrFrames };
+			for (int frame{}; frame < nrTotalFrames; ++frame)
+			{
+				//Numbered from the first timed frame, the copy is part of the frame time and the encoding isn't
+				if (frame == options.nrWarmupFrames && options.captureInterval > 0)
+				{
+					renderer.SetCaptureInterval(options.captureInterval, options.capturePathPrefix, options.captureExtension);
+				}
+
+				const uint64_t frameStartNs{ Profiler::GetTimestampNs() };
+				const float time{ static_cast<float>(frame) * options.frameStepSec };
+
+				if (options.settings.isRotating)
+				{
+					scene.SetVehicleRotation(time);
+				}
+				UpdateCamera(scene.GetCamera(), time);
+
+				//Dynamic resolution reacts to the real frame time, not the scripted step
+				scene.RenderFrame(previousFrameSec);
+
+				const uint64_t frameEndNs{ Profiler::GetTimestampNs() };
+				previousFrameSec = static_cast<float>(frameEndNs - frameStartNs) * 1e-9f;
+				if (frame >= options.nrWarmupFrames)
+				{
+					frameHistory.Add(frameEndNs - startNs, frameEndNs - frameStartNs);
+				}
+			}
+
+			int exitCode{};
+			constexpr size_t frameStatWindows[]{ 60, 600, 3600 };
+			if (!options.csvPath.empty() && !frameHistory.WriteCsv(options.csvPath))
+			{
+				std::cerr << "Could not write " << options.csvPath << '\n';
+				exitCode = 1;
+			}
+			if (!options.jsonPath.empty() && !frameHistory.WriteJson(options.jsonPath, frameStatWindows))
+			{
+				std::cerr << "Could not write " << options.jsonPath << '\n';
+				exitCode = 1;
+			}
+			if (!options.imagePath.empty() && SDL_SaveBMP(const_cast<SDL_Surface*>(renderer.GetFrontBuffer()), options.imagePath.c_str()) != 0)
+			{
+				std::cerr << "Could not write " << options.imagePath << ": " << SDL_GetError() << '\n';
+				exitCode = 1;
+			}
+
+			FrameCapture& frameCapture{ renderer.GetFrameCapture() };
+			frameCapture.Flush();
+			if (frameCapture.GetNrFailed() > 0)
+			{
+				std::cerr << frameCapture.GetNrFailed() << " captures could not be written\n";
+				exitCode = 1;
+			}
+
+			const FrameStats stats{ frameHistory.Calculate() };
+			std::cout << "{ \"width\": " << options.width
+				<< ", \"height\": " << options.height
+				<< ", \"mode\": \"" << GetRenderModeName(options.settings.renderMode) << '"'
+				<< ", \"cull\": \"" << GetCullModeName(options.cullMode) << '"'
+				<< ", \"lights\": " << options.nrLights
+				<< ", \"frames\": " << stats.nrFrames
+				<< ", \"minNs\": " << stats.minNs
+				<< ", \"avgNs\": " << stats.avgNs
+				<< ", \"p50Ns\": " << stats.p50Ns
+				<< ", \"p95Ns\": " << stats.p95Ns
+				<< ", \"p99Ns\": " << stats.p99Ns
+				<< ", \"maxNs\": " << stats.maxNs
+				<< ", \"stutters\": " << stats.nrStutters
+				<< ", \"captured\": " << frameCapture.GetNrWritten()
+				<< ", \"capturesDropped\": " << frameCapture.GetNrDropped() << " }\n";
+			return exitCode;
+		}
+
+		int Run(int argc, char* args[])
+		{
+			HeadlessOptions options{};
+			std::string error{};
+			if (!ParseArguments(argc, args, options, error))
+			{
+				std::cerr << error << '\n';
+				PrintUsage();
+				return 2;
+			}
+			return Run(options);
+		}
+	}
+}
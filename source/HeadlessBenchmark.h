@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+
+#include "GlobalDefinitions.h"
+#include "SoftwareRenderer.h"
+
+namespace dae
+{
+	struct HeadlessOptions
+	{
+		int width{ 640 };
+		int height{ 480 };
+		int nrFrames{ 600 };
+		//Rendered before the timed frames so caches and dynamic resolution settle, not reported
+		int nrWarmupFrames{ 30 };
+		//Step of the scripted camera and rotation, fixed so every run renders the same images
+		float frameStepSec{ 1.f / 60.f };
+
+		CullMode cullMode{ Back };
+		SoftwareRenderSettings settings{};
+		bool isOcclusionCulling{ true };
+		int nrLights{};
+
+		//Empty paths are not written
+		std::string csvPath{};
+		std::string jsonPath{};
+		std::string imagePath{};
+
+		//Every Nth timed frame goes to <capturePathPrefix><frame><captureExtension> on the capture thread, 0 captures nothing
+		int captureInterval{};
+		std::string capturePathPrefix{ "Capture_" };
+		std::string captureExtension{ ".png" };
+	};
+
+	//Renders the vehicle scene with the software renderer into memory, no window, DirectX or input.
+	//The camera and the rotation follow a scripted path, the timings are written as CSV/JSON
+	//and a one line JSON summary is the last line on stdout.
+	namespace HeadlessBenchmark
+	{
+		//True when the command line asks for the headless mode
+		bool IsRequested(int argc, char* args[]);
+
+		//Returns false and fills error for an unknown or malformed argument
+		bool ParseArguments(int argc, char* args[], HeadlessOptions& options, std::string& error);
+		void PrintUsage();
+
+		//Process exit code, 0 on success
+		int Run(const HeadlessOptions& options);
+		int Run(int argc, char* args[]);
+	}
+}
@@ -0,0 +1,23 @@
+#include "pch.h"
+
+#undef main
+#include "HeadlessBenchmark.h"
+#include "RegressionSuite.h"
+#include "MicroBenchmarks.h"
+
+using namespace dae;
+
+//Entry of the SOFTWARE_ONLY build (CMakeLists.txt): the modes of main.cpp that need neither a window nor DirectX.
+//Without a mode argument it runs the headless benchmark, so --headless is optional here.
+int main(int argc, char* args[])
+{
+	if (RegressionSuite::IsRequested(argc, args))
+	{
+		return RegressionSuite::Run(argc, args);
+	}
+	if (MicroBenchmarks::IsRequested(argc, args))
+	{
+		return MicroBenchmarks::Run(argc, args);
+	}
+	return HeadlessBenchmark::Run(argc, args);
+}
@@ -0,0 +1,83 @@
+#include "pch.h"
+#include "HeadlessScene.h"
+#include "Profiler.h"
+
+namespace dae
+{
+	namespace
+	{
+		//Vehicle at its spawn position
+		constexpr Vector3 g_SceneCenter{ 0.f, 0.f, 50.f };
+	}
+
+	HeadlessScene::HeadlessScene(int width, int height)
+	{
+		m_pGlobalMeshes.push_back(new GlobalMesh{});
+		m_pGlobalMeshes.push_back(new GlobalMesh{});
+
+		m_pRenderer = new SoftwareRenderer{ width, height, m_pGlobalMeshes, &m_Camera, &m_CullMode, &m_AssetCache };
+		m_AssetCache.ReleaseUnused();
+
+		m_Camera.Initialize(static_cast<float>(width) / static_cast<float>(height), 45.f, { 0,0,0 });
+		m_Camera.UpdateMatrices();
+
+		for (const GlobalMesh* pGlobalMesh : m_pGlobalMeshes)
+		{
+			m_SpawnMatrices.push_back(*pGlobalMesh->pWorldMatrix);
+		}
+		ApplySettings({});
+	}
+
+	HeadlessScene::~HeadlessScene()
+	{
+		delete m_pRenderer;
+		for (const GlobalMesh* pGlobalMesh : m_pGlobalMeshes)
+		{
+			delete pGlobalMesh;
+		}
+	}
+
+	void HeadlessScene::ApplySettings(const SoftwareRenderSettings& settings)
+	{
+		SoftwareRenderSettings rendererSettings{ settings };
+		rendererSettings.isRotating = false;
+		m_pRenderer->ApplySettings(rendererSettings);
+	}
+
+	void HeadlessScene::AddLights(int nrLights)
+	{
+		//The colors cycle so neighbouring lights don't look like one
+		constexpr ColorRGB colors[]{ { 1.f, 0.3f, 0.3f }, { 0.3f, 1.f, 0.3f }, { 0.3f, 0.3f, 1.f }, { 1.f, 0.9f, 0.5f } };
+		for (int i{}; i < nrLights; ++i)
+		{
+			const float angle{ 2.f * PI * static_cast<float>(i) / static_cast<float>(nrLights) };
+
+			Light light{};
+			light.position = g_SceneCenter + Vector3{ 15.f * cosf(angle), 4.f, 15.f * sinf(angle) };
+			light.color = colors[i % std::size(colors)];
+			light.intensity = 400.f;
+			light.range = 30.f;
+			m_pRenderer->AddLight(light);
+		}
+	}
+
+	void HeadlessScene::SetVehicleRotation(float angle)
+	{
+		const Matrix rotation{ Matrix::CreateRotationY(angle) };
+		for (size_t i{}; i < m_pGlobalMeshes.size(); ++i)
+		{
+			m_pGlobalMeshes[i]->SetWorldMatrix(rotation * m_SpawnMatrices[i]);
+		}
+	}
+
+	uint64_t HeadlessScene::RenderFrame(float elapsedSec)
+	{
+		const uint64_t startNs{ Profiler::GetTimestampNs() };
+
+		m_pRenderer->Update(elapsedSec);
+		m_OcclusionBuffer.CullMeshes(m_pGlobalMeshes, m_Camera);
+		m_pRenderer->Render();
+
+		return Profiler::GetTimestampNs() - startNs;
+	}
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "AssetCache.h"
+#include "Camera.h"
+#include "GlobalDefinitions.h"
+#include "OcclusionBuffer.h"
+#include "SoftwareRenderer.h"
+
+namespace dae
+{
+	//The vehicle scene rendered by the software renderer into memory, no window, DirectX or input.
+	//The caller drives the camera and the rotation, shared by the headless benchmark and the regression suite.
+	class HeadlessScene final
+	{
+	public:
+		HeadlessScene(int width, int height);
+		~HeadlessScene();
+
+		HeadlessScene(const HeadlessScene&) = delete;
+		HeadlessScene(HeadlessScene&&) noexcept = delete;
+		HeadlessScene& operator=(const HeadlessScene&) = delete;
+		HeadlessScene& operator=(HeadlessScene&&) noexcept = delete;
+
+		SoftwareRenderer& GetRenderer() { return *m_pRenderer; }
+		Camera& GetCamera() { return m_Camera; }
+		OcclusionBuffer& GetOcclusionBuffer() { return m_OcclusionBuffer; }
+
+		//isRotating is ignored, SetVehicleRotation replaces the rotation of the renderer
+		void ApplySettings(const SoftwareRenderSettings& settings);
+		void SetCullMode(CullMode cullMode) { m_CullMode = cullMode; }
+
+		//Ring of point lights around the vehicle
+		void AddLights(int nrLights);
+		//Around the y axis of the spawn position, in radians
+		void SetVehicleRotation(float angle);
+
+		//Update, visibility and render of one frame, returns how long that took in nanoseconds
+		uint64_t RenderFrame(float elapsedSec);
+
+	private:
+		std::vector<GlobalMesh*> m_pGlobalMeshes{};
+		std::vector<Matrix> m_SpawnMatrices{};
+		Camera m_Camera{};
+		CullMode m_CullMode{ Back };
+		AssetCache m_AssetCache{};
+		OcclusionBuffer m_OcclusionBuffer{};
+		SoftwareRenderer* m_pRenderer{ nullptr };
+	};
+}
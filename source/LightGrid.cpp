@@ -0,0 +1,142 @@
+#include "pch.h"
+#include "LightGrid.h"
+#include "Camera.h"
+
+namespace dae
+{
+	LightGrid::LightGrid(int width, int height)
+		: m_Width{ width }
+		, m_Height{ height }
+		, m_NrTilesX{ (width + m_TileSize - 1) / m_TileSize }
+		, m_NrTilesY{ (height + m_TileSize - 1) / m_TileSize }
+	{
+		m_Clusters.resize(static_cast<size_t>(m_NrTilesX) * m_NrTilesY * m_NrDepthSlices);
+	}
+
+	void LightGrid::Resize(int width, int height)
+	{
+		m_Width = width;
+		m_Height = height;
+		m_NrTilesX = (width + m_TileSize - 1) / m_TileSize;
+		m_NrTilesY = (height + m_TileSize - 1) / m_TileSize;
+	}
+
+	void LightGrid::Build(const std::vector<Light>& lights, const Camera& camera)
+	{
+		m_Lights = lights;
+		m_Near = camera.nearC;
+		m_Far = camera.farC;
+		m_DepthSliceScale = static_cast<float>(m_NrDepthSlices) / log2f(m_Far / m_Near);
+
+		const size_t nrClusters{ static_cast<size_t>(m_NrTilesX) * m_NrTilesY * m_NrDepthSlices };
+		std::fill_n(m_Clusters.begin(), nrClusters, Cluster{});
+		m_LightIndices.clear();
+
+		if (m_Lights.empty())
+			return;
+
+		//Find the cluster range touched by the bounding sphere of every light
+		std::vector<ClusterRange>& ranges{ m_LightRanges };
+		ranges.assign(m_Lights.size(), ClusterRange{});
+
+		for (size_t i{}; i < m_Lights.size(); ++i)
+		{
+			const Light& light{ m_Lights[i] };
+			const Vector3 center{ camera.viewMatrix.TransformPoint(light.position) };
+			const float minDepth{ center.z - light.range };
+			const float maxDepth{ center.z + light.range };
+
+			//Behind the camera or past the far plane
+			if (maxDepth < m_Near || minDepth > m_Far)
+				continue;
+
+			ClusterRange& range{ ranges[i] };
+			range.minSlice = GetDepthSlice(minDepth);
+			range.maxSlice = GetDepthSlice(maxDepth);
+
+			//Sphere crosses the near plane, it can cover the whole screen
+			if (minDepth <= m_Near)
+			{
+				range.minTileX = 0;
+				range.maxTileX = m_NrTilesX - 1;
+				range.minTileY = 0;
+				range.maxTileY = m_NrTilesY - 1;
+				continue;
+			}
+
+			//Project the corners of the view space bounding box
+			Vector2 minScreen{ FLT_MAX, FLT_MAX };
+			Vector2 maxScreen{ -FLT_MAX, -FLT_MAX };
+			for (const float depth : { minDepth, maxDepth })
+			{
+				for (const float offsetX : { -light.range, light.range })
+				{
+					for (const float offsetY : { -light.range, light.range })
+					{
+						Vector4 projected{ camera.projectionMatrix.TransformPoint(Vector4{ center.x + offsetX, center.y + offsetY, depth, 1.f }) };
+						projected.x /= projected.w;
+						projected.y /= projected.w;
+
+						const Vector2 screen{ (projected.x + 1) / 2 * static_cast<float>(m_Width), (1 - projected.y) / 2 * static_cast<float>(m_Height) };
+						minScreen = Vector2::Min(minScreen, screen);
+						maxScreen = Vector2::Max(maxScreen, screen);
+					}
+				}
+			}
+
+			if (maxScreen.x < 0.f || maxScreen.y < 0.f || minScreen.x >= static_cast<float>(m_Width) || minScreen.y >= static_cast<float>(m_Height))
+			{
+				range.maxSlice = -1;
+				continue;
+			}
+
+			range.minTileX = Clamp(static_cast<int>(minScreen.x) / m_TileSize, 0, m_NrTilesX - 1);
+			range.maxTileX = Clamp(static_cast<int>(maxScreen.x) / m_TileSize, 0, m_NrTilesX - 1);
+			range.minTileY = Clamp(static_cast<int>(minScreen.y) / m_TileSize, 0, m_NrTilesY - 1);
+			range.maxTileY = Clamp(static_cast<int>(maxScreen.y) / m_TileSize, 0, m_NrTilesY - 1);
+		}
+
+		//Count lights per cluster
+		for (const ClusterRange& range : ranges)
+		{
+			for (int slice{ range.minSlice }; slice <= range.maxSlice; ++slice)
+			{
+				for (int tileY{ range.minTileY }; tileY <= range.maxTileY; ++tileY)
+				{
+					for (int tileX{ range.minTileX }; tileX <= range.maxTileX; ++tileX)
+					{
+						++m_Clusters[GetClusterIndex(tileX, tileY, slice)].count;
+					}
+				}
+			}
+		}
+
+		//Prefix sum into offsets, count becomes the write cursor
+		uint32_t offset{};
+		for (size_t i{}; i < nrClusters; ++i)
+		{
+			Cluster& cluster{ m_Clusters[i] };
+			cluster.offset = offset;
+			offset += cluster.count;
+			cluster.count = 0;
+		}
+		m_LightIndices.resize(offset);
+
+		//Fill the flat index list
+		for (size_t i{}; i < ranges.size(); ++i)
+		{
+			const ClusterRange& range{ ranges[i] };
+			for (int slice{ range.minSlice }; slice <= range.maxSlice; ++slice)
+			{
+				for (int tileY{ range.minTileY }; tileY <= range.maxTileY; ++tileY)
+				{
+					for (int tileX{ range.minTileX }; tileX <= range.maxTileX; ++tileX)
+					{
+						Cluster& cluster{ m_Clusters[GetClusterIndex(tileX, tileY, slice)] };
+						m_LightIndices[cluster.offset + cluster.count++] = static_cast<uint32_t>(i);
+					}
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Math.h"
+#include "GlobalDefinitions.h"
+
+namespace dae
+{
+	struct Camera;
+
+	enum class LightType
+	{
+		Point,
+		Spot
+	};
+
+	struct Light
+	{
+		LightType type{ LightType::Point };
+		Vector3 position{};
+		Vector3 direction{ Vector3::UnitZ }; //Spot only
+		ColorRGB color{ colors::White };
+		float intensity{ 1.f };
+		float range{ 10.f };
+		float cosInnerAngle{ 0.9f }; //Spot only
+		float cosOuterAngle{ 0.8f }; //Spot only
+
+		//Distance window (smooth falloff to zero at range) and spot cone
+		float GetAttenuation(float distance, const Vector3& directionFromLight) const
+		{
+			const float distanceRatio{ distance / range };
+			const float window{ Square(Saturate(1.f - Square(Square(distanceRatio)))) };
+			float attenuation{ window / std::max(Square(distance), 0.01f) };
+
+			if (type == LightType::Spot)
+			{
+				const float cosAngle{ Vector3::Dot(direction, directionFromLight) };
+				attenuation *= Saturate((cosAngle - cosOuterAngle) / (cosInnerAngle - cosOuterAngle));
+			}
+			return attenuation;
+		}
+	};
+
+	//Clustered light assignment, screen tiles x exponential depth slices rebuilt every frame
+	class LightGrid final
+	{
+	public:
+		LightGrid(int width, int height);
+
+		//Follows the render resolution, the clusters are allocated for the size passed to the constructor
+		void Resize(int width, int height);
+		void Build(const std::vector<Light>& lights, const Camera& camera);
+
+		//Indices of the lights that can reach the cluster of this fragment
+		std::span<const uint32_t> GetLightIndices(int x, int y, float viewDepth) const
+		{
+			const int tileX{ x / m_TileSize };
+			const int tileY{ y / m_TileSize };
+			const Cluster& cluster{ m_Clusters[GetClusterIndex(tileX, tileY, GetDepthSlice(viewDepth))] };
+			return { m_LightIndices.data() + cluster.offset, cluster.count };
+		}
+
+		const Light& GetLight(uint32_t index) const { return m_Lights[index]; }
+		bool IsEmpty() const { return m_Lights.empty(); }
+
+	private:
+		struct Cluster
+		{
+			uint32_t offset{};
+			uint32_t count{};
+		};
+
+		struct ClusterRange
+		{
+			int minTileX{}, maxTileX{ -1 };
+			int minTileY{}, maxTileY{ -1 };
+			int minSlice{}, maxSlice{ -1 };
+		};
+
+		static constexpr int m_TileSize{ 32 };
+		static constexpr int m_NrDepthSlices{ 16 };
+
+		int m_Width{};
+		int m_Height{};
+		int m_NrTilesX{};
+		int m_NrTilesY{};
+
+		float m_Near{};
+		float m_Far{};
+		float m_DepthSliceScale{};
+
+		std::vector<Light> m_Lights{};
+		std::vector<Cluster> m_Clusters{};
+		std::vector<uint32_t> m_LightIndices{};
+		std::vector<ClusterRange> m_LightRanges{};
+
+		int GetClusterIndex(int tileX, int tileY, int slice) const
+		{
+			return (slice * m_NrTilesY + tileY) * m_NrTilesX + tileX;
+		}
+
+		int GetDepthSlice(float viewDepth) const
+		{
+			if (viewDepth <= m_Near) return 0;
+			return Clamp(static_cast<int>(ShadingPrecision::Log2(viewDepth / m_Near) * m_DepthSliceScale), 0, m_NrDepthSlices - 1);
+		}
+	};
+}
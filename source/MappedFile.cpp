@@ -0,0 +1,71 @@
+#include "pch.h"
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace dae
+{
+	MappedFile::MappedFile(const std::string& path)
+	{
+#ifdef _WIN32
+		const HANDLE file{ CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr) };
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER fileSize{};
+		if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+		{
+			//The view keeps the mapping alive, both handles can be closed right away
+			const HANDLE mapping{ CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr) };
+			if (mapping)
+			{
+				m_pData = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+				m_Size = m_pData ? static_cast<size_t>(fileSize.QuadPart) : 0;
+				CloseHandle(mapping);
+			}
+		}
+		CloseHandle(file);
+#else
+		const int file{ open(path.c_str(), O_RDONLY) };
+		if (file < 0)
+			return;
+
+		const off_t fileSize{ lseek(file, 0, SEEK_END) };
+		if (fileSize > 0)
+		{
+			void* pData{ mmap(nullptr, static_cast<size_t>(fileSize), PROT_READ, MAP_PRIVATE, file, 0) };
+			if (pData != MAP_FAILED)
+			{
+				m_pData = static_cast<const char*>(pData);
+				m_Size = static_cast<size_t>(fileSize);
+			}
+		}
+		close(file);
+#endif
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Unmap();
+	}
+
+	void MappedFile::Unmap()
+	{
+		if (!m_pData)
+			return;
+
+#ifdef _WIN32
+		UnmapViewOfFile(m_pData);
+#else
+		munmap(const_cast<char*>(m_pData), m_Size);
+#endif
+		m_pData = nullptr;
+		m_Size = 0;
+	}
+}
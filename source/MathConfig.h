@@ -0,0 +1,17 @@
+#pragma once
+
+//SSE is part of every x64 target, other targets use the scalar paths
+#if defined(_M_X64) || defined(__SSE2__)
+#include <xmmintrin.h>
+#define MATH_SSE
+#endif
+
+//The math types are header only, the hot operations are forced inline so the raster loops never call out.
+//The CMake build checks that with the RasterKernelsMakeNoCalls test.
+#if defined(_MSC_VER)
+#define MATH_INLINE __forceinline
+#define MATH_INLINE_LAMBDA [[msvc::forceinline]]
+#else
+#define MATH_INLINE inline __attribute__((always_inline))
+#define MATH_INLINE_LAMBDA __attribute__((always_inline))
+#endif
@@ -1,5 +1,12 @@
 #pragma once
+#include <algorithm>
+#include <bit>
+#include <cfloat>
 #include <cmath>
+#include <cstdint>
+#include <type_traits>
+
+#include "MathConfig.h"
 
 namespace dae
 {
@@ -21,44 +28,177 @@ namespace dae
 	constexpr auto TO_RADIANS(PI / 180.0f);
 
 	/* --- HELPER FUNCTIONS --- */
-	inline float Square(float a)
+	constexpr float Square(float a) noexcept
 	{
 		return a * a;
 	}
 
-	inline float Lerpf(float a, float b, float factor)
+	constexpr float Lerpf(float a, float b, float factor) noexcept
 	{
 		return ((1 - factor) * a) + (factor * b);
 	}
 
-	inline bool AreEqual(float a, float b, float epsilon = FLT_EPSILON)
+	constexpr bool AreEqual(float a, float b, float epsilon = FLT_EPSILON) noexcept
 	{
-		return abs(a - b) < epsilon;
+		const float difference{ a - b };
+		return (difference < 0.f ? -difference : difference) < epsilon;
 	}
 
-	inline int Clamp(const int v, int min, int max)
+	constexpr int Clamp(const int v, int min, int max) noexcept
 	{
 		if (v < min) return min;
 		if (v > max) return max;
 		return v;
 	}
 
-	inline float Clamp(const float v, float min, float max)
+	constexpr float Clamp(const float v, float min, float max) noexcept
 	{
 		if (v < min) return min;
 		if (v > max) return max;
 		return v;
 	}
 
-	inline float Saturate(const float v)
+	constexpr float Saturate(const float v) noexcept
 	{
 		if (v < 0.f) return 0.f;
 		if (v > 1.f) return 1.f;
 		return v;
 	}
-	inline float Remap(float depthValue, const float min, const float max)
+
+	constexpr float Remap(float depthValue, const float min, const float max) noexcept
 	{
 		depthValue = std::clamp(depthValue, min, max);
 		return (depthValue - min) / (max - min);
 	}
-}
\ No newline at end of file
+
+	//std::sin and std::cos are not constexpr, at compile time a Taylor series in double is used instead.
+	//It is accurate far below float precision on [-PI, PI], so constant matrices match the runtime ones.
+	constexpr double SinSeries(double angle) noexcept
+	{
+		const double twoPi{ 6.283185307179586476925 };
+		const double turns{ angle / twoPi };
+		angle -= twoPi * static_cast<double>(static_cast<long long>(turns + (turns < 0.0 ? -0.5 : 0.5)));
+
+		double term{ angle };
+		double sum{ angle };
+		for (int i{ 1 }; i <= 12; ++i)
+		{
+			term *= -angle * angle / ((2 * i) * (2 * i + 1));
+			sum += term;
+		}
+		return sum;
+	}
+
+	constexpr float Sin(float angle) noexcept
+	{
+		if (std::is_constant_evaluated())
+			return static_cast<float>(SinSeries(angle));
+		return std::sin(angle);
+	}
+
+	constexpr float Cos(float angle) noexcept
+	{
+		if (std::is_constant_evaluated())
+			return static_cast<float>(SinSeries(static_cast<double>(angle) + 1.57079632679489661923));
+		return std::cos(angle);
+	}
+
+	/* --- PRECISION POLICIES --- */
+	//Picked at compile time by the caller, ExactPrecision is the IEEE sqrt and divide
+	struct ExactPrecision final
+	{
+		static constexpr bool IsExact{ true };
+
+		MATH_INLINE static float InvSqrt(float value) noexcept
+		{
+			return 1.f / sqrtf(value);
+		}
+
+		MATH_INLINE static constexpr float Reciprocal(float value) noexcept
+		{
+			return 1.f / value;
+		}
+
+		MATH_INLINE static float Log2(float value) noexcept
+		{
+			return log2f(value);
+		}
+
+		MATH_INLINE static float Exp2(float value) noexcept
+		{
+			return exp2f(value);
+		}
+
+		MATH_INLINE static float Pow(float base, float exponent) noexcept
+		{
+			return powf(base, exponent);
+		}
+	};
+
+	//Hardware estimates refined with one Newton-Raphson step, about 22 of the 24 mantissa bits are correct
+	struct FastPrecision final
+	{
+		static constexpr bool IsExact{ false };
+
+		MATH_INLINE static float InvSqrt(float value) noexcept
+		{
+#ifdef MATH_SSE
+			const float estimate{ _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(value))) };
+			return estimate * (1.5f - 0.5f * value * estimate * estimate);
+#else
+			return ExactPrecision::InvSqrt(value);
+#endif
+		}
+
+		MATH_INLINE static float Reciprocal(float value) noexcept
+		{
+#ifdef MATH_SSE
+			const float estimate{ _mm_cvtss_f32(_mm_rcp_ss(_mm_set_ss(value))) };
+			return estimate * (2.f - value * estimate);
+#else
+			return ExactPrecision::Reciprocal(value);
+#endif
+		}
+
+		//Exponent bits plus an atanh series for the mantissa, for values above zero
+		MATH_INLINE static float Log2(float value) noexcept
+		{
+			//Mantissa kept in [sqrt(0.5), sqrt(2)) so the series converges fast
+			const int32_t bits{ std::bit_cast<int32_t>(value) };
+			int32_t exponent{ (bits >> 23) - 127 };
+			float mantissa{ std::bit_cast<float>((bits & 0x007FFFFF) | 0x3F800000) };
+			if (mantissa > 1.41421356f)
+			{
+				mantissa *= 0.5f;
+				++exponent;
+			}
+			const float t{ (mantissa - 1.f) / (mantissa + 1.f) };
+			const float t2{ t * t };
+			return static_cast<float>(exponent) + t * (2.88539008f + t2 * (0.961796694f + t2 * (0.577078016f + t2 * 0.412198583f)));
+		}
+
+		//The whole part goes into the exponent bits, the fraction through the Taylor series of e^x
+		MATH_INLINE static float Exp2(float value) noexcept
+		{
+			const float power{ std::clamp(value, -126.f, 127.f) };
+			int32_t whole{ static_cast<int32_t>(power) };
+			if (power < static_cast<float>(whole))
+			{
+				--whole;
+			}
+			const float x{ (power - static_cast<float>(whole)) * 0.693147181f };
+			const float fraction{ 1.f + x * (1.f + x * (1.f / 2.f + x * (1.f / 6.f + x * (1.f / 24.f + x * (1.f / 120.f + x * (1.f / 720.f + x * (1.f / 5040.f + x * (1.f / 40320.f)))))))) };
+			return fraction * std::bit_cast<float>((whole + 127) << 23);
+		}
+
+		//For bases and exponents of zero and up, the relative error stays below 1e-5
+		MATH_INLINE static float Pow(float base, float exponent) noexcept
+		{
+			if (!(base >= FLT_MIN))
+			{
+				return exponent == 0.f ? 1.f : 0.f;
+			}
+			return Exp2(exponent * Log2(base));
+		}
+	};
+}
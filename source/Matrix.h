@@ -1,4 +1,7 @@
 #pragma once
+#include <cstddef>
+
+#include "MathHelpers.h"
 #include "Vector3.h"
 #include "Vector4.h"
 
@@ -6,55 +9,256 @@ namespace dae {
 	struct Matrix
 	{
 		Matrix() = default;
-		Matrix(
+		constexpr Matrix(
 			const Vector3& xAxis,
 			const Vector3& yAxis,
 			const Vector3& zAxis,
-			const Vector3& t);
+			const Vector3& t) noexcept :
+			Matrix({ xAxis, 0 }, { yAxis, 0 }, { zAxis, 0 }, { t, 1 })
+		{
+		}
 
-		Matrix(
+		constexpr Matrix(
 			const Vector4& xAxis,
 			const Vector4& yAxis,
 			const Vector4& zAxis,
-			const Vector4& t);
-
-		Matrix(const Matrix& m);
-
-		Vector3 TransformVector(const Vector3& v) const;
-		Vector3 TransformVector(float x, float y, float z) const;
-		Vector3 TransformPoint(const Vector3& p) const;
-		Vector3 TransformPoint(float x, float y, float z) const;
-
-		Vector4 TransformPoint(const Vector4& p) const;
-		Vector4 TransformPoint(float x, float y, float z, float w) const;
-
-		const Matrix& Transpose();
-		const Matrix& Inverse();
-
-		Vector3 GetAxisX() const;
-		Vector3 GetAxisY() const;
-		Vector3 GetAxisZ() const;
-		Vector3 GetTranslation() const;
-
-		static Matrix CreateTranslation(float x, float y, float z);
-		static Matrix CreateTranslation(const Vector3& t);
-		static Matrix CreateRotationX(float pitch);
-		static Matrix CreateRotationY(float yaw);
-		static Matrix CreateRotationZ(float roll);
-		static Matrix CreateRotation(float pitch, float yaw, float roll);
-		static Matrix CreateRotation(const Vector3& r);
-		static Matrix CreateScale(float sx, float sy, float sz);
-		static Matrix CreateScale(const Vector3& s);
-		static Matrix Transpose(const Matrix& m);
-		static Matrix Inverse(const Matrix& m);
-
-		static Matrix CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up);
-		static Matrix CreatePerspectiveFovLH(float fovy, float aspect, float zn, float zf);
-
-		Vector4& operator[](int index);
-		Vector4 operator[](int index) const;
-		Matrix operator*(const Matrix& m) const;
-		const Matrix& operator*=(const Matrix& m);
+			const Vector4& t) noexcept :
+			data{ xAxis, yAxis, zAxis, t }
+		{
+		}
+
+		constexpr Matrix(const Matrix& m) = default;
+		constexpr Matrix& operator=(const Matrix& m) = default;
+
+		MATH_INLINE constexpr Vector3 TransformVector(const Vector3& v) const noexcept { return TransformVector(v.x, v.y, v.z); }
+		MATH_INLINE constexpr Vector3 TransformVector(float x, float y, float z) const noexcept
+		{
+#ifdef MATH_SSE
+			if (!std::is_constant_evaluated())
+			{
+				const Vector4 result{ _mm_add_ps(_mm_add_ps(_mm_mul_ps(data[0].Load(), _mm_set1_ps(x)), _mm_mul_ps(data[1].Load(), _mm_set1_ps(y))), _mm_mul_ps(data[2].Load(), _mm_set1_ps(z))) };
+				return { result.x, result.y, result.z };
+			}
+#endif
+			return Vector3{
+				data[0].x * x + data[1].x * y + data[2].x * z,
+				data[0].y * x + data[1].y * y + data[2].y * z,
+				data[0].z * x + data[1].z * y + data[2].z * z
+			};
+		}
+
+		MATH_INLINE constexpr Vector3 TransformPoint(const Vector3& p) const noexcept { return TransformPoint(p.x, p.y, p.z); }
+		MATH_INLINE constexpr Vector3 TransformPoint(float x, float y, float z) const noexcept
+		{
+			const Vector4 result{ TransformPoint(x, y, z, 1.f) };
+			return { result.x, result.y, result.z };
+		}
+
+		MATH_INLINE constexpr Vector4 TransformPoint(const Vector4& p) const noexcept { return TransformPoint(p.x, p.y, p.z, p.w); }
+		MATH_INLINE constexpr Vector4 TransformPoint(float x, float y, float z, float w) const noexcept
+		{
+#ifdef MATH_SSE
+			if (!std::is_constant_evaluated())
+			{
+				//Same operation order as the scalar path, both give the same bits
+				__m128 result{ _mm_mul_ps(data[0].Load(), _mm_set1_ps(x)) };
+				result = _mm_add_ps(result, _mm_mul_ps(data[1].Load(), _mm_set1_ps(y)));
+				result = _mm_add_ps(result, _mm_mul_ps(data[2].Load(), _mm_set1_ps(z)));
+				result = _mm_add_ps(result, _mm_mul_ps(data[3].Load(), _mm_set1_ps(w)));
+				return Vector4{ result };
+			}
+#endif
+			return Vector4{
+				data[0].x * x + data[1].x * y + data[2].x * z + data[3].x * w,
+				data[0].y * x + data[1].y * y + data[2].y * z + data[3].y * w,
+				data[0].z * x + data[1].z * y + data[2].z * z + data[3].z * w,
+				data[0].w * x + data[1].w * y + data[2].w * z + data[3].w * w
+			};
+		}
+
+		//Batched versions for structure of arrays input, 4 elements per SSE instruction
+		void TransformPoints(const float* pX, const float* pY, const float* pZ, size_t count, Vector4* pOutput) const noexcept;
+		void TransformVectors(const float* pX, const float* pY, const float* pZ, size_t count, float* pOutX, float* pOutY, float* pOutZ) const noexcept;
+
+		constexpr const Matrix& Transpose() noexcept
+		{
+			Matrix result{};
+			for (int r{ 0 }; r < 4; ++r)
+			{
+				for (int c{ 0 }; c < 4; ++c)
+				{
+					result[r][c] = data[c][r];
+				}
+			}
+
+			*this = result;
+			return *this;
+		}
+
+		constexpr const Matrix& Inverse() noexcept
+		{
+			//Optimized Inverse as explained in FGED1 - used widely in other libraries too.
+			const Vector3 a = data[0];
+			const Vector3 b = data[1];
+			const Vector3 c = data[2];
+			const Vector3 d = data[3];
+
+			const float x = data[0][3];
+			const float y = data[1][3];
+			const float z = data[2][3];
+			const float w = data[3][3];
+
+			Vector3 s = Vector3::Cross(a, b);
+			Vector3 t = Vector3::Cross(c, d);
+			Vector3 u = a * y - b * x;
+			Vector3 v = c * w - d * z;
+
+			const float det = Vector3::Dot(s, v) + Vector3::Dot(t, u);
+			assert((!AreEqual(det, 0.f)) && "ERROR: determinant is 0, there is no INVERSE!");
+			const float invDet = 1.f / det;
+
+			s *= invDet; t *= invDet; u *= invDet; v *= invDet;
+
+			const Vector3 r0 = Vector3::Cross(b, v) + t * y;
+			const Vector3 r1 = Vector3::Cross(v, a) - t * x;
+			const Vector3 r2 = Vector3::Cross(d, u) + s * w;
+			//Vector3 r3 = Vector3::Cross(u, c) - s * z;
+
+			data[0] = Vector4{ r0.x, r1.x, r2.x, 0.f };
+			data[1] = Vector4{ r0.y, r1.y, r2.y, 0.f };
+			data[2] = Vector4{ r0.z, r1.z, r2.z, 0.f };
+			data[3] = { -Vector3::Dot(b, t),Vector3::Dot(a, t),-Vector3::Dot(d, s),Vector3::Dot(c, s) };
+
+			return *this;
+		}
+
+		MATH_INLINE constexpr Vector3 GetAxisX() const noexcept { return data[0]; }
+		MATH_INLINE constexpr Vector3 GetAxisY() const noexcept { return data[1]; }
+		MATH_INLINE constexpr Vector3 GetAxisZ() const noexcept { return data[2]; }
+		MATH_INLINE constexpr Vector3 GetTranslation() const noexcept { return data[3]; }
+
+		static constexpr Matrix CreateTranslation(float x, float y, float z) noexcept
+		{
+			return CreateTranslation({ x, y, z });
+		}
+
+		static constexpr Matrix CreateTranslation(const Vector3& t) noexcept
+		{
+			return { Vector3::UnitX, Vector3::UnitY, Vector3::UnitZ, t };
+		}
+
+		//Sin and Cos fall back to a series at compile time, so constant rotations cost nothing at runtime
+		static constexpr Matrix CreateRotationX(float pitch) noexcept
+		{
+			return {
+				{1, 0, 0, 0},
+				{0, Cos(pitch), -Sin(pitch), 0},
+				{0, Sin(pitch), Cos(pitch), 0},
+				{0, 0, 0, 1}
+			};
+		}
+
+		static constexpr Matrix CreateRotationY(float yaw) noexcept
+		{
+			return {
+				{Cos(yaw), 0, -Sin(yaw), 0},
+				{0, 1, 0, 0},
+				{Sin(yaw), 0, Cos(yaw), 0},
+				{0, 0, 0, 1}
+			};
+		}
+
+		static constexpr Matrix CreateRotationZ(float roll) noexcept
+		{
+			return {
+				{Cos(roll), Sin(roll), 0, 0},
+				{-Sin(roll), Cos(roll), 0, 0},
+				{0, 0, 1, 0},
+				{0, 0, 0, 1}
+			};
+		}
+
+		static constexpr Matrix CreateRotation(float pitch, float yaw, float roll) noexcept
+		{
+			return CreateRotation({ pitch, yaw, roll });
+		}
+
+		static constexpr Matrix CreateRotation(const Vector3& r) noexcept
+		{
+			return CreateRotationX(r[0]) * CreateRotationY(r[1]) * CreateRotationZ(r[2]);
+		}
+
+		static constexpr Matrix CreateScale(float sx, float sy, float sz) noexcept
+		{
+			return { {sx, 0, 0}, {0, sy, 0}, {0, 0, sz}, Vector3::Zero };
+		}
+
+		static constexpr Matrix CreateScale(const Vector3& s) noexcept
+		{
+			return CreateScale(s[0], s[1], s[2]);
+		}
+
+		static constexpr Matrix Transpose(const Matrix& m) noexcept
+		{
+			Matrix out{ m };
+			out.Transpose();
+
+			return out;
+		}
+
+		static constexpr Matrix Inverse(const Matrix& m) noexcept
+		{
+			Matrix out{ m };
+			out.Inverse();
+
+			return out;
+		}
+
+		static Matrix CreateLookAtLH(const Vector3& origin, const Vector3& forward, const Vector3& up)
+		{
+			assert(false && "Not Implemented");
+			return {};
+		}
+
+		static constexpr Matrix CreatePerspectiveFovLH(float fov, float aspect, float zn, float zf) noexcept
+		{
+			Matrix temp{};
+			temp.data[0] = { 1.f / (aspect * fov), 0, 0, 0 };
+			temp.data[1] = { 0, 1.f / fov, 0, 0 };
+			temp.data[2] = { 0, 0, zf / (zf - zn), 1 };
+			temp.data[3] = { 0, 0, -(zf * zn) / (zf - zn), 0 };
+			return temp;
+		}
+
+		constexpr Vector4& operator[](int index) noexcept
+		{
+			assert(index <= 3 && index >= 0);
+			return data[index];
+		}
+
+		constexpr Vector4 operator[](int index) const noexcept
+		{
+			assert(index <= 3 && index >= 0);
+			return data[index];
+		}
+
+		MATH_INLINE constexpr Matrix operator*(const Matrix& m) const noexcept
+		{
+			//Every row of the result is this row transforming the rows of m
+			Matrix result{};
+			for (int r{ 0 }; r < 4; ++r)
+			{
+				result.data[r] = m.TransformPoint(data[r]);
+			}
+
+			return result;
+		}
+
+		MATH_INLINE constexpr const Matrix& operator*=(const Matrix& m) noexcept
+		{
+			*this = *this * m;
+			return *this;
+		}
 
 	private:
 
@@ -72,4 +276,88 @@ namespace dae {
 		// v2x v2y v2z v2w
 		// v3x v3y v3z v3w
 	};
+
+	inline void Matrix::TransformPoints(const float* pX, const float* pY, const float* pZ, size_t count, Vector4* pOutput) const noexcept
+	{
+		size_t i{};
+#ifdef MATH_SSE
+		//Every matrix element broadcast once, each lane is another point
+		__m128 m[4][4];
+		for (int r{ 0 }; r < 4; ++r)
+		{
+			for (int c{ 0 }; c < 4; ++c)
+			{
+				m[r][c] = _mm_set1_ps(data[r][c]);
+			}
+		}
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 x{ _mm_loadu_ps(pX + i) };
+			const __m128 y{ _mm_loadu_ps(pY + i) };
+			const __m128 z{ _mm_loadu_ps(pZ + i) };
+
+			__m128 result[4];
+			for (int c{ 0 }; c < 4; ++c)
+			{
+				result[c] = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][c], x), _mm_mul_ps(m[1][c], y)), _mm_mul_ps(m[2][c], z)), m[3][c]);
+			}
+
+			//Back to one Vector4 per point
+			_MM_TRANSPOSE4_PS(result[0], result[1], result[2], result[3]);
+			for (size_t j{ 0 }; j < 4; ++j)
+			{
+				_mm_store_ps(&pOutput[i + j].x, result[j]);
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			pOutput[i] = TransformPoint(pX[i], pY[i], pZ[i], 1.f);
+		}
+	}
+
+	inline void Matrix::TransformVectors(const float* pX, const float* pY, const float* pZ, size_t count, float* pOutX, float* pOutY, float* pOutZ) const noexcept
+	{
+		size_t i{};
+#ifdef MATH_SSE
+		__m128 m[3][3];
+		for (int r{ 0 }; r < 3; ++r)
+		{
+			for (int c{ 0 }; c < 3; ++c)
+			{
+				m[r][c] = _mm_set1_ps(data[r][c]);
+			}
+		}
+
+		for (; i + 4 <= count; i += 4)
+		{
+			const __m128 x{ _mm_loadu_ps(pX + i) };
+			const __m128 y{ _mm_loadu_ps(pY + i) };
+			const __m128 z{ _mm_loadu_ps(pZ + i) };
+
+			float* pOutputs[3]{ pOutX, pOutY, pOutZ };
+			for (int c{ 0 }; c < 3; ++c)
+			{
+				_mm_storeu_ps(pOutputs[c] + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][c], x), _mm_mul_ps(m[1][c], y)), _mm_mul_ps(m[2][c], z)));
+			}
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			const Vector3 result{ TransformVector(pX[i], pY[i], pZ[i]) };
+			pOutX[i] = result.x;
+			pOutY[i] = result.y;
+			pOutZ[i] = result.z;
+		}
+	}
+
+	//Every definition is in the headers, so the math also works in constant expressions
+	namespace MatrixChecks
+	{
+		constexpr Matrix g_Rotation{ Matrix::CreateRotation(0.3f, 1.2f, 0.f) * Matrix::CreateScale(2.f, 2.f, 2.f) };
+		static_assert(AreEqual(g_Rotation.TransformVector(Vector3::UnitY).SqrMagnitude(), 4.f, 1e-5f));
+		static_assert(AreEqual(Vector3::Dot(Vector3::Cross(Vector3::UnitX, Vector3::UnitY), Vector3::UnitZ), 1.f));
+		static_assert(AreEqual((Matrix::Inverse(g_Rotation) * g_Rotation)[3][3], 1.f, 1e-5f));
+	}
 }
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "pch.h"
+#include "MeshCache.h"
+
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+
+namespace dae
+{
+	namespace MeshCache
+	{
+		namespace
+		{
+			constexpr uint32_t g_Magic{ 0x4D454144 }; //"DAEM"
+			constexpr uint32_t g_FlipAxisAndWinding{ 1 << 0 };
+			constexpr uint32_t g_KeepTriangleOrder{ 1 << 1 };
+
+			//Size and write time of the OBJ, a cache built from another version of the file is stale
+			bool GetSourceStamp(const std::string& objPath, uint64_t& size, int64_t& time)
+			{
+				std::error_code error{};
+				size = std::filesystem::file_size(objPath, error);
+				if (error)
+					return false;
+
+				const auto writeTime{ std::filesystem::last_write_time(objPath, error) };
+				if (error)
+					return false;
+
+				time = writeTime.time_since_epoch().count();
+				return true;
+			}
+
+			size_t GetFileSize(const Header& header)
+			{
+				return sizeof(Header) + header.nrVertices * sizeof(CachedVertex) + header.nrIndices * sizeof(uint32_t);
+			}
+
+			//<cache>.<random>.tmp, every writer gets a file of its own even when several processes miss the cache at once
+			std::string GetTempPath(const std::string& cachePath)
+			{
+				std::random_device random{};
+				const uint64_t id{ (static_cast<uint64_t>(random()) << 32 | random()) ^ std::hash<std::thread::id>{}(std::this_thread::get_id()) };
+
+				std::ostringstream path{};
+				path << cachePath << '.' << std::hex << id << ".tmp";
+				return path.str();
+			}
+		}
+
+		std::string GetCachePath(const std::string& objPath)
+		{
+			return std::filesystem::path{ objPath }.replace_extension(".mesh").string();
+		}
+
+		uint32_t GetFlags(const MeshImportOptions& options)
+		{
+			return (options.flipAxisAndWinding ? g_FlipAxisAndWinding : 0) | (options.keepTriangleOrder ? g_KeepTriangleOrder : 0);
+		}
+
+		MappedMesh::MappedMesh(const std::string& objPath, const MeshImportOptions& options)
+			: m_File{ GetCachePath(objPath) }
+		{
+			uint64_t sourceSize{};
+			int64_t sourceTime{};
+			if (!m_File.IsValid() || m_File.GetSize() < sizeof(Header) || !GetSourceStamp(objPath, sourceSize, sourceTime))
+			{
+				m_File.Unmap();
+				return;
+			}
+
+			const Header* pHeader{ reinterpret_cast<const Header*>(m_File.GetData()) };
+			const bool isValid
+			{
+				pHeader->magic == g_Magic &&
+				pHeader->version == Version &&
+				pHeader->flags == GetFlags(options) &&
+				pHeader->vertexSize == sizeof(CachedVertex) &&
+				pHeader->sourceSize == sourceSize &&
+				pHeader->sourceTime == sourceTime &&
+				GetFileSize(*pHeader) == m_File.GetSize()
+			};
+
+			if (isValid)
+			{
+				m_pHeader = pHeader;
+			}
+			else
+			{
+				m_File.Unmap();
+			}
+		}
+
+		std::span<const CachedVertex> MappedMesh::GetVertices() const
+		{
+			const auto pVertices{ reinterpret_cast<const CachedVertex*>(m_pHeader + 1) };
+			return { pVertices, m_pHeader->nrVertices };
+		}
+
+		std::span<const uint32_t> MappedMesh::GetIndices() const
+		{
+			const auto pIndices{ reinterpret_cast<const uint32_t*>(GetVertices().data() + m_pHeader->nrVertices) };
+			return { pIndices, m_pHeader->nrIndices };
+		}
+
+		void CalculateBounds(std::span<const CachedVertex> vertices, Vector3& boundsMin, Vector3& boundsMax)
+		{
+			boundsMin = { FLT_MAX, FLT_MAX, FLT_MAX };
+			boundsMax = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+			for (const CachedVertex& vertex : vertices)
+			{
+				boundsMin = Vector3::Min(boundsMin, vertex.position);
+				boundsMax = Vector3::Max(boundsMax, vertex.position);
+			}
+		}
+
+		bool Write(const std::string& objPath, const MeshImportOptions& options, uint64_t contentHash, std::span<const CachedVertex> vertices, std::span<const uint32_t> indices, const Vector3& boundsMin, const Vector3& boundsMax)
+		{
+			Header header{};
+			header.magic = g_Magic;
+			header.version = Version;
+			header.flags = GetFlags(options);
+			header.vertexSize = sizeof(CachedVertex);
+			header.contentHash = contentHash;
+			header.nrVertices = static_cast<uint32_t>(vertices.size());
+			header.nrIndices = static_cast<uint32_t>(indices.size());
+			header.boundsMin = boundsMin;
+			header.boundsMax = boundsMax;
+			if (!GetSourceStamp(objPath, header.sourceSize, header.sourceTime))
+				return false;
+
+			//Write to a temporary file of this writer and rename, a concurrent reader never maps a half written cache
+			//and concurrent writers never write into the same file. The last rename wins, every cache it can leave is complete.
+			const std::string cachePath{ GetCachePath(objPath) };
+			const std::string tempPath{ GetTempPath(cachePath) };
+			std::error_code error{};
+			{
+				std::ofstream file{ tempPath, std::ios::binary | std::ios::trunc };
+				if (!file)
+					return false;
+
+				file.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+				file.write(reinterpret_cast<const char*>(vertices.data()), static_cast<std::streamsize>(vertices.size_bytes()));
+				file.write(reinterpret_cast<const char*>(indices.data()), static_cast<std::streamsize>(indices.size_bytes()));
+				file.close();
+				if (!file)
+				{
+					std::filesystem::remove(tempPath, error);
+					return false;
+				}
+			}
+
+			std::filesystem::rename(tempPath, cachePath, error);
+			if (error)
+			{
+				std::filesystem::remove(tempPath, error);
+				return false;
+			}
+			return true;
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+
+#include "Math.h"
+#include "MappedFile.h"
+
+namespace dae
+{
+	//How an OBJ becomes a triangle list, a cache written with other options is rebuilt
+	struct MeshImportOptions
+	{
+		//Mirror z and reverse the winding, the OBJ files are right handed
+		bool flipAxisAndWinding{ true };
+		//Only the vertices get reordered, for meshes that are blended in the order their triangles are drawn
+		bool keepTriangleOrder{ false };
+	};
+
+	//Binary copy of an imported OBJ, written after the first import and memory mapped on every load after that.
+	//Vertices are welded and optimized, tangents are the accumulated (unnormalized) face tangents.
+	namespace MeshCache
+	{
+		//Bump when the layout or the importers change, older files are rebuilt from the OBJ
+		constexpr uint32_t Version{ 3 };
+
+		struct CachedVertex
+		{
+			Vector3 position{};
+			Vector3 normal{};
+			Vector3 tangent{};
+			Vector2 uv{};
+		};
+
+		struct Header
+		{
+			uint32_t magic{};
+			uint32_t version{};
+			uint32_t flags{};
+			uint32_t vertexSize{};
+			uint64_t sourceSize{};
+			int64_t sourceTime{};
+			//Hash of the OBJ the cache was built from, lets a cached load find a shared copy without reading the OBJ
+			uint64_t contentHash{};
+			uint32_t nrVertices{};
+			uint32_t nrIndices{};
+			Vector3 boundsMin{};
+			Vector3 boundsMax{};
+		};
+
+		//Read only view of a cache file, valid as long as the object lives
+		class MappedMesh final
+		{
+		public:
+			//Maps the cache of this OBJ, stays invalid when there is none or it is out of date
+			MappedMesh(const std::string& objPath, const MeshImportOptions& options);
+
+			bool IsValid() const { return m_pHeader != nullptr; }
+
+			std::span<const CachedVertex> GetVertices() const;
+			std::span<const uint32_t> GetIndices() const;
+			const Vector3& GetBoundsMin() const { return m_pHeader->boundsMin; }
+			const Vector3& GetBoundsMax() const { return m_pHeader->boundsMax; }
+			uint64_t GetContentHash() const { return m_pHeader->contentHash; }
+
+		private:
+			MappedFile m_File;
+			const Header* m_pHeader{ nullptr };
+		};
+
+		//Writes the cache next to the OBJ, a failed write only costs the next startup a parse
+		bool Write(const std::string& objPath, const MeshImportOptions& options, uint64_t contentHash, std::span<const CachedVertex> vertices, std::span<const uint32_t> indices, const Vector3& boundsMin, const Vector3& boundsMax);
+
+		//Box around the positions, stored in the header so a cached load doesn't walk the vertices for it
+		void CalculateBounds(std::span<const CachedVertex> vertices, Vector3& boundsMin, Vector3& boundsMax);
+
+		std::string GetCachePath(const std::string& objPath);
+		//The options as stored in the header
+		uint32_t GetFlags(const MeshImportOptions& options);
+	}
+}
@@ -0,0 +1,265 @@
+#include "pch.h"
+#include "MeshOptimizer.h"
+
+namespace dae
+{
+	namespace MeshOptimizer
+	{
+		namespace
+		{
+			constexpr int g_CacheSize{ 32 };
+
+			float GetVertexScore(int cachePosition, uint32_t nrRemainingTriangles)
+			{
+				//No triangles left, the vertex can't pull anything in anymore
+				if (nrRemainingTriangles == 0)
+					return -1.f;
+
+				float score{};
+				if (cachePosition >= 0)
+				{
+					//The vertices of the last triangle get a fixed score so the next one doesn't just reuse them
+					if (cachePosition < 3)
+					{
+						score = 0.75f;
+					}
+					else
+					{
+						score = powf(1.f - static_cast<float>(cachePosition - 3) / (g_CacheSize - 3), 1.5f);
+					}
+				}
+
+				//Favour vertices with few triangles left, finishing them removes them from the cache
+				return score + 2.f / sqrtf(static_cast<float>(nrRemainingTriangles));
+			}
+		}
+
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t nrVertices)
+		{
+			const size_t nrTriangles{ indices.size() / 3 };
+			if (nrTriangles == 0)
+				return;
+
+			//Triangles per vertex, the first remaining[v] entries of every range are the ones not emitted yet
+			std::vector<uint32_t> remaining(nrVertices);
+			for (const uint32_t index : indices)
+			{
+				++remaining[index];
+			}
+
+			std::vector<uint32_t> offsets(nrVertices + 1);
+			for (size_t v{}; v < nrVertices; ++v)
+			{
+				offsets[v + 1] = offsets[v] + remaining[v];
+			}
+
+			std::vector<uint32_t> adjacency(indices.size());
+			{
+				std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+				for (size_t i{}; i < indices.size(); ++i)
+				{
+					adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			std::vector<int> cachePositions(nrVertices, -1);
+			std::vector<float> vertexScores(nrVertices);
+			for (size_t v{}; v < nrVertices; ++v)
+			{
+				vertexScores[v] = GetVertexScore(-1, remaining[v]);
+			}
+
+			std::vector<float> triangleScores(nrTriangles);
+			for (size_t t{}; t < nrTriangles; ++t)
+			{
+				triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+			}
+
+			std::vector<bool> isEmitted(nrTriangles);
+			std::vector<uint32_t> output{};
+			output.reserve(indices.size());
+
+			std::vector<uint32_t> cache{};
+			std::vector<uint32_t> newCache{};
+			cache.reserve(g_CacheSize + 3);
+			newCache.reserve(g_CacheSize + 3);
+
+			size_t searchCursor{};
+			int64_t bestTriangle{ -1 };
+			while (output.size() < indices.size())
+			{
+				//Nothing in the cache is connected to a triangle anymore, continue in input order
+				if (bestTriangle < 0)
+				{
+					while (isEmitted[searchCursor])
+					{
+						++searchCursor;
+					}
+					bestTriangle = static_cast<int64_t>(searchCursor);
+				}
+
+				const size_t triangle{ static_cast<size_t>(bestTriangle) };
+				isEmitted[triangle] = true;
+
+				newCache.clear();
+				for (size_t corner{}; corner < 3; ++corner)
+				{
+					const uint32_t vertex{ indices[triangle * 3 + corner] };
+					output.push_back(vertex);
+					newCache.push_back(vertex);
+
+					//Swap the triangle out of the remaining part of the adjacency range
+					uint32_t* pBegin{ adjacency.data() + offsets[vertex] };
+					uint32_t* pLast{ pBegin + remaining[vertex] - 1 };
+					for (uint32_t* pTriangle{ pBegin }; pTriangle <= pLast; ++pTriangle)
+					{
+						if (*pTriangle == triangle)
+						{
+							std::swap(*pTriangle, *pLast);
+							break;
+						}
+					}
+					--remaining[vertex];
+				}
+
+				//Most recently used first, the vertices that fall out lose their cache score
+				for (const uint32_t vertex : cache)
+				{
+					if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end())
+					{
+						newCache.push_back(vertex);
+					}
+				}
+				for (size_t i{}; i < newCache.size(); ++i)
+				{
+					const uint32_t vertex{ newCache[i] };
+					cachePositions[vertex] = i < g_CacheSize ? static_cast<int>(i) : -1;
+					vertexScores[vertex] = GetVertexScore(cachePositions[vertex], remaining[vertex]);
+				}
+
+				//Only triangles that touch the cache changed score, the best of them goes next
+				bestTriangle = -1;
+				float bestScore{ -1.f };
+				for (const uint32_t vertex : newCache)
+				{
+					const uint32_t* pBegin{ adjacency.data() + offsets[vertex] };
+					for (const uint32_t* pTriangle{ pBegin }; pTriangle < pBegin + remaining[vertex]; ++pTriangle)
+					{
+						const size_t t{ *pTriangle };
+						triangleScores[t] = vertexScores[indices[t * 3]] + vertexScores[indices[t * 3 + 1]] + vertexScores[indices[t * 3 + 2]];
+						if (triangleScores[t] > bestScore)
+						{
+							bestScore = triangleScores[t];
+							bestTriangle = static_cast<int64_t>(t);
+						}
+					}
+				}
+
+				if (newCache.size() > g_CacheSize)
+				{
+					newCache.resize(g_CacheSize);
+				}
+				cache.swap(newCache);
+			}
+
+			indices.swap(output);
+		}
+
+		void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vector3>& positions)
+		{
+			constexpr uint32_t fifoCacheSize{ 16 };
+			constexpr size_t minClusterSize{ 16 };
+
+			const size_t nrTriangles{ indices.size() / 3 };
+			if (nrTriangles == 0)
+				return;
+
+			//Split where the cache would be cold anyway: a triangle that misses on all three vertices
+			std::vector<size_t> clusterStarts{ 0 };
+			std::vector<uint32_t> cacheStamps(positions.size(), 0);
+			uint32_t time{ fifoCacheSize + 1 };
+			for (size_t t{}; t < nrTriangles; ++t)
+			{
+				uint32_t nrMisses{};
+				for (size_t corner{}; corner < 3; ++corner)
+				{
+					const uint32_t vertex{ indices[t * 3 + corner] };
+					if (time - cacheStamps[vertex] > fifoCacheSize)
+					{
+						cacheStamps[vertex] = time++;
+						++nrMisses;
+					}
+				}
+
+				if (nrMisses == 3 && t - clusterStarts.back() >= minClusterSize)
+				{
+					clusterStarts.push_back(t);
+				}
+			}
+			clusterStarts.push_back(nrTriangles);
+
+			//Area weighted centroid of the whole mesh and of every cluster
+			struct Cluster
+			{
+				size_t begin{};
+				size_t end{};
+				float sortKey{};
+			};
+
+			std::vector<Cluster> clusters(clusterStarts.size() - 1);
+			std::vector<Vector3> clusterCentroids(clusters.size());
+			std::vector<Vector3> clusterNormals(clusters.size());
+			Vector3 meshCentroid{};
+			float meshArea{};
+
+			for (size_t c{}; c < clusters.size(); ++c)
+			{
+				clusters[c].begin = clusterStarts[c];
+				clusters[c].end = clusterStarts[c + 1];
+
+				float clusterArea{};
+				for (size_t t{ clusters[c].begin }; t < clusters[c].end; ++t)
+				{
+					const Vector3& p0{ positions[indices[t * 3]] };
+					const Vector3& p1{ positions[indices[t * 3 + 1]] };
+					const Vector3& p2{ positions[indices[t * 3 + 2]] };
+
+					const Vector3 normal{ Vector3::Cross(p1 - p0, p2 - p0) };
+					const float area{ normal.Magnitude() };
+					const Vector3 centroid{ (p0 + p1 + p2) / 3.f };
+
+					clusterCentroids[c] += centroid * area;
+					clusterNormals[c] += normal;
+					clusterArea += area;
+				}
+
+				meshCentroid += clusterCentroids[c];
+				meshArea += clusterArea;
+				if (clusterArea > 0.f)
+				{
+					clusterCentroids[c] = clusterCentroids[c] / clusterArea;
+				}
+			}
+			if (meshArea > 0.f)
+			{
+				meshCentroid = meshCentroid / meshArea;
+			}
+
+			//Clusters that face away from the center are likely in front of the rest, draw them first
+			for (size_t c{}; c < clusters.size(); ++c)
+			{
+				const float normalLength{ clusterNormals[c].Magnitude() };
+				clusters[c].sortKey = normalLength > 0.f ? Vector3::Dot(clusterCentroids[c] - meshCentroid, clusterNormals[c] / normalLength) : 0.f;
+			}
+			std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+			std::vector<uint32_t> output{};
+			output.reserve(indices.size());
+			for (const Cluster& cluster : clusters)
+			{
+				output.insert(output.end(), indices.begin() + static_cast<ptrdiff_t>(cluster.begin * 3), indices.begin() + static_cast<ptrdiff_t>(cluster.end * 3));
+			}
+			indices.swap(output);
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Math.h"
+
+namespace dae
+{
+	//Position/uv/normal index tuple of an OBJ face corner, corners with the same tuple share one vertex
+	struct ObjCorner
+	{
+		size_t position{};
+		size_t uv{};
+		size_t normal{};
+
+		bool operator==(const ObjCorner& other) const = default;
+	};
+
+	struct ObjCornerHash
+	{
+		size_t operator()(const ObjCorner& corner) const
+		{
+			size_t hash{ std::hash<size_t>{}(corner.position) };
+			hash ^= std::hash<size_t>{}(corner.uv) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			hash ^= std::hash<size_t>{}(corner.normal) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+			return hash;
+		}
+	};
+
+	namespace MeshOptimizer
+	{
+		//Reorders triangles for the post transform vertex cache (Forsyth, linear speed vertex cache optimization)
+		void OptimizeVertexCache(std::vector<uint32_t>& indices, size_t nrVertices);
+
+		//Reorders the clusters of a cache optimized index buffer so triangles on the outside are drawn first (Sander et al.)
+		void OptimizeOverdraw(std::vector<uint32_t>& indices, const std::vector<Vector3>& positions);
+
+		//Renumbers vertices in the order the index buffer first uses them, unused vertices are dropped
+		template<typename Vertex>
+		void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+		{
+			std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+			std::vector<Vertex> reordered{};
+			reordered.reserve(vertices.size());
+
+			for (uint32_t& index : indices)
+			{
+				if (remap[index] == UINT32_MAX)
+				{
+					remap[index] = static_cast<uint32_t>(reordered.size());
+					reordered.push_back(vertices[index]);
+				}
+				index = remap[index];
+			}
+			vertices.swap(reordered);
+		}
+
+		//Runs the three passes on a welded triangle list
+		template<typename Vertex, typename GetPosition>
+		void Optimize(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, GetPosition getPosition)
+		{
+			OptimizeVertexCache(indices, vertices.size());
+
+			std::vector<Vector3> positions{};
+			positions.reserve(vertices.size());
+			for (const Vertex& vertex : vertices)
+			{
+				positions.push_back(getPosition(vertex));
+			}
+			OptimizeOverdraw(indices, positions);
+
+			OptimizeVertexFetch(vertices, indices);
+		}
+	}
+}
@@ -0,0 +1,117 @@
+#include "pch.h"
+#include "Meshlet.h"
+
+namespace dae
+{
+	namespace
+	{
+		void CalculateMeshletBounds(const Mesh& mesh, const std::vector<uint32_t>& meshletVertices, Meshlet& meshlet)
+		{
+			//Sphere around the center of the box
+			Vector3 min{ FLT_MAX, FLT_MAX, FLT_MAX };
+			Vector3 max{ -FLT_MAX, -FLT_MAX, -FLT_MAX };
+			for (uint32_t i{}; i < meshlet.vertexCount; ++i)
+			{
+				const Vector3& position{ mesh.vertices[meshletVertices[meshlet.vertexOffset + i]].position };
+				min = Vector3::Min(min, position);
+				max = Vector3::Max(max, position);
+			}
+			meshlet.center = (min + max) * 0.5f;
+
+			float sqrRadius{};
+			for (uint32_t i{}; i < meshlet.vertexCount; ++i)
+			{
+				sqrRadius = std::max(sqrRadius, (mesh.vertices[meshletVertices[meshlet.vertexOffset + i]].position - meshlet.center).SqrMagnitude());
+			}
+			meshlet.radius = sqrtf(sqrRadius);
+
+			//Normal cone around the average face normal (winding normal, the one the rasterizer culls on)
+			std::vector<Vector3> normals{};
+			normals.reserve(meshlet.triangleCount);
+			Vector3 axis{};
+			for (uint32_t t{}; t < meshlet.triangleCount; ++t)
+			{
+				const size_t i{ (static_cast<size_t>(meshlet.triangleOffset) + t) * 3 };
+				const Vector3& v0{ mesh.vertices[mesh.indices[i]].position };
+				Vector3 normal{ Vector3::Cross(mesh.vertices[mesh.indices[i + 1]].position - v0, mesh.vertices[mesh.indices[i + 2]].position - v0) };
+				if (normal.SqrMagnitude() <= FLT_EPSILON * FLT_EPSILON)
+					continue;
+
+				normal.Normalize();
+				normals.push_back(normal);
+				axis += normal;
+			}
+
+			meshlet.coneCutoff = 2.f;
+			if (normals.empty() || axis.SqrMagnitude() <= FLT_EPSILON)
+				return;
+
+			meshlet.coneAxis = axis.Normalized();
+			float minDot{ 1.f };
+			for (const Vector3& normal : normals)
+			{
+				minDot = std::min(minDot, Vector3::Dot(normal, meshlet.coneAxis));
+			}
+
+			//Cones of 90 degrees or wider always have a triangle facing the camera
+			if (minDot > 0.f)
+			{
+				meshlet.coneCutoff = sqrtf(1.f - minDot * minDot);
+			}
+		}
+	}
+
+	void BuildMeshlets(const Mesh& mesh, std::vector<Meshlet>& meshlets, std::vector<uint32_t>& meshletVertices)
+	{
+		meshlets.clear();
+		meshletVertices.clear();
+
+		//Meshlet that last used every vertex, avoids a lookup table per meshlet
+		std::vector<uint32_t> vertexOwners(mesh.vertices.size(), UINT32_MAX);
+
+		Meshlet meshlet{};
+		const auto finishMeshlet = [&]()
+		{
+			if (meshlet.triangleCount == 0)
+				return;
+
+			CalculateMeshletBounds(mesh, meshletVertices, meshlet);
+			meshlets.push_back(meshlet);
+
+			meshlet = Meshlet{};
+			meshlet.vertexOffset = static_cast<uint32_t>(meshletVertices.size());
+			meshlet.triangleOffset = meshlets.back().triangleOffset + meshlets.back().triangleCount;
+		};
+
+		const uint32_t nrTriangles{ static_cast<uint32_t>(mesh.indices.size() / 3) };
+		for (uint32_t t{}; t < nrTriangles; ++t)
+		{
+			const uint32_t* pTriangle{ &mesh.indices[static_cast<size_t>(t) * 3] };
+			const uint32_t meshletIndex{ static_cast<uint32_t>(meshlets.size()) };
+
+			uint32_t nrNewVertices{};
+			for (uint32_t corner{}; corner < 3; ++corner)
+			{
+				nrNewVertices += vertexOwners[pTriangle[corner]] != meshletIndex;
+			}
+
+			if (meshlet.vertexCount + nrNewVertices > Meshlet::MaxVertices || meshlet.triangleCount + 1 > Meshlet::MaxTriangles)
+			{
+				finishMeshlet();
+			}
+
+			const uint32_t owner{ static_cast<uint32_t>(meshlets.size()) };
+			for (uint32_t corner{}; corner < 3; ++corner)
+			{
+				if (vertexOwners[pTriangle[corner]] != owner)
+				{
+					vertexOwners[pTriangle[corner]] = owner;
+					meshletVertices.push_back(pTriangle[corner]);
+					++meshlet.vertexCount;
+				}
+			}
+			++meshlet.triangleCount;
+		}
+		finishMeshlet();
+	}
+}
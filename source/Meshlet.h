@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+#include "DataTypes.h"
+
+namespace dae
+{
+	//Cluster of neighbouring triangles that is culled as a whole before any of its vertices is transformed
+	struct Meshlet
+	{
+		static constexpr uint32_t MaxVertices{ 64 };
+		static constexpr uint32_t MaxTriangles{ 124 };
+
+		//Range in the meshlet vertex list (indices into Mesh::vertices)
+		uint32_t vertexOffset{};
+		uint32_t vertexCount{};
+		//Range of triangles in Mesh::indices, the triangles of one meshlet are contiguous
+		uint32_t triangleOffset{};
+		uint32_t triangleCount{};
+
+		//Object space bounding sphere
+		Vector3 center{};
+		float radius{};
+
+		//Normal cone, every triangle normal is within the cone. A cutoff above 1 means it can't be culled.
+		Vector3 coneAxis{};
+		float coneCutoff{ 2.f };
+	};
+
+	//Splits a triangle list into meshlets in index order, run it after the indices are optimized for locality
+	void BuildMeshlets(const Mesh& mesh, std::vector<Meshlet>& meshlets, std::vector<uint32_t>& meshletVertices);
+}
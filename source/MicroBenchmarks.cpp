@@ -0,0 +1,386 @@
+#include "pch.h"
+#include "MicroBenchmarks.h"
+#include "BenchmarkUtils.h"
+#include "HeadlessScene.h"
+#include "ObjImporter.h"
+#include "Profiler.h"
+#include "SWUtils.h"
+
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <random>
+
+namespace dae
+{
+	namespace MicroBenchmarks
+	{
+		namespace
+		{
+			//A batch runs nrOperations operations and returns something that depends on their results
+			struct Benchmark
+			{
+				std::string name{};
+				int nrOperations{};
+				std::function<float()> run{};
+			};
+
+			struct Statistics
+			{
+				double medianNs{};
+				double minNs{};
+				//Standard deviation over the mean of the repetitions, in percent
+				double variationPercent{};
+			};
+
+			//Every batch result ends up here, so the optimizer can't drop the work that produced it
+			volatile float g_Sink{};
+
+			constexpr int g_NrElements{ 4096 };
+			constexpr const char* g_MeshPath{ "Resources/vehicle.obj" };
+
+			//Resolution of the raster benchmarks, the largest triangle has to fit with its offset
+			constexpr int g_RasterWidth{ 800 };
+			constexpr int g_RasterHeight{ 600 };
+			constexpr float g_TriangleOffset{ 16.f };
+			//Pixels covered per batch, so every triangle size takes about the same time
+			constexpr int g_RasterPixelsPerBatch{ 131072 };
+
+			constexpr const char* g_BaselinesHeader{ "benchmark,medianNs" };
+
+			//The same inputs for every repetition, spread so the loops don't run on one cache line
+			struct Inputs
+			{
+				Matrix worldViewProjection{};
+				std::vector<float> xs{}, ys{}, zs{};
+				std::vector<Vector4> projected{};
+
+				std::vector<Vector3> vectors{};
+				std::vector<Vector3> normalized{};
+
+				AssetCache assets{};
+				std::unique_ptr<SoftwareTexture> pDiffuse{}, pNormal{}, pSpecular{}, pGloss{};
+				std::vector<Vector2> uvs{};
+				std::vector<ColorRGB> colors{};
+
+				std::vector<VehicleVaryings> varyings{};
+				std::vector<Fragment> fragments{};
+
+				std::vector<MeshCache::CachedVertex> importedVertices{};
+				std::vector<Vertex_In> parsedVertices{};
+				std::vector<uint32_t> indices{};
+			};
+
+			void CreateInputs(Inputs& inputs, const Camera& camera)
+			{
+				inputs.worldViewProjection = Matrix::CreateRotation(0.3f, 1.2f, 0.f) * Matrix::CreateTranslation(0.f, 0.f, 50.f) * camera.viewProjectionMatrix;
+
+				//Fixed seed, every run times the same values
+				std::mt19937 random{ 2024 };
+				std::uniform_real_distribution<float> position{ -20.f, 20.f };
+				std::uniform_real_distribution<float> unit{ 0.f, 1.f };
+
+				inputs.xs.resize(g_NrElements);
+				inputs.ys.resize(g_NrElements);
+				inputs.zs.resize(g_NrElements);
+				inputs.projected.resize(g_NrElements);
+				inputs.vectors.resize(g_NrElements);
+				inputs.normalized.resize(g_NrElements);
+				inputs.uvs.resize(g_NrElements);
+				inputs.colors.resize(g_NrElements);
+				inputs.varyings.resize(g_NrElements);
+				inputs.fragments.resize(g_NrElements);
+
+				const Vector3 lightDirection{ ShaderGlobals{}.lightDirection };
+				for (int i{}; i < g_NrElements; ++i)
+				{
+					inputs.xs[i] = position(random);
+					inputs.ys[i] = position(random);
+					inputs.zs[i] = position(random);
+					inputs.vectors[i] = { position(random), position(random), position(random) };
+					inputs.uvs[i] = { unit(random), unit(random) };
+
+					//Normals around the light so the specular term isn't always zero
+					VehicleVaryings& varyings{ inputs.varyings[i] };
+					varyings.uv = inputs.uvs[i];
+					varyings.normal = (-lightDirection + Vector3{ unit(random), unit(random), unit(random) } * 0.5f).Normalized();
+					varyings.tangent = Vector3::Cross(varyings.normal, Vector3::UnitY).Normalized();
+					varyings.viewDirection = { position(random), position(random), 50.f };
+					inputs.fragments[i] = { i % g_RasterWidth, i / g_RasterWidth, 50.f };
+				}
+
+				inputs.pDiffuse.reset(SoftwareTexture::LoadFromFile(inputs.assets, "Resources/vehicle_diffuse.png"));
+				inputs.pNormal.reset(SoftwareTexture::LoadFromFile(inputs.assets, "Resources/vehicle_normal.png"));
+				inputs.pSpecular.reset(SoftwareTexture::LoadFromFile(inputs.assets, "Resources/vehicle_specular.png"));
+				inputs.pGloss.reset(SoftwareTexture::LoadFromFile(inputs.assets, "Resources/vehicle_gloss.png"));
+			}
+
+			template<RenderMode renderMode>
+			Benchmark CreatePixelShadingBenchmark(const char* pModeName, Inputs& inputs)
+			{
+				return { std::string{ "PixelShading " } + pModeName, g_NrElements, [&inputs]()
+					{
+						VehiclePixelStage pixelStage{};
+						pixelStage.pDiffuse = inputs.pDiffuse.get();
+						pixelStage.pNormal = inputs.pNormal.get();
+						pixelStage.pSpecular = inputs.pSpecular.get();
+						pixelStage.pGloss = inputs.pGloss.get();
+
+						const ShaderGlobals globals{};
+						for (int i{}; i < g_NrElements; ++i)
+						{
+							inputs.colors[i] = pixelStage(inputs.varyings[i], globals, inputs.fragments[i], ShadingKernel<true, renderMode>{});
+						}
+						return inputs.colors[g_NrElements / 2].r;
+					} };
+			}
+
+			std::vector<Benchmark> CreateBenchmarks(Inputs& inputs, SoftwareRenderer& renderer)
+			{
+				std::vector<Benchmark> benchmarks{};
+
+				//Vertex math
+				benchmarks.push_back({ "Matrix::TransformPoint", g_NrElements, [&inputs]()
+					{
+						for (int i{}; i < g_NrElements; ++i)
+						{
+							inputs.projected[i] = inputs.worldViewProjection.TransformPoint(inputs.xs[i], inputs.ys[i], inputs.zs[i], 1.f);
+						}
+						return inputs.projected[g_NrElements / 2].w;
+					} });
+				benchmarks.push_back({ "Matrix::TransformPoints", g_NrElements, [&inputs]()
+					{
+						inputs.worldViewProjection.TransformPoints(inputs.xs.data(), inputs.ys.data(), inputs.zs.data(), g_NrElements, inputs.projected.data());
+						return inputs.projected[g_NrElements / 2].w;
+					} });
+				benchmarks.push_back({ "Vector3::Normalized<Exact>", g_NrElements, [&inputs]()
+					{
+						for (int i{}; i < g_NrElements; ++i)
+						{
+							inputs.normalized[i] = inputs.vectors[i].Normalized<ExactPrecision>();
+						}
+						return inputs.normalized[g_NrElements / 2].x;
+					} });
+				benchmarks.push_back({ "Vector3::Normalized<Fast>", g_NrElements, [&inputs]()
+					{
+						for (int i{}; i < g_NrElements; ++i)
+						{
+							inputs.normalized[i] = inputs.vectors[i].Normalized<FastPrecision>();
+						}
+						return inputs.normalized[g_NrElements / 2].x;
+					} });
+
+				//Sampling, random uvs so most fetches miss the texel of the previous one
+				benchmarks.push_back({ "SoftwareTexture::Sample", g_NrElements, [&inputs]()
+					{
+						for (int i{}; i < g_NrElements; ++i)
+						{
+							inputs.colors[i] = inputs.pDiffuse->Sample(inputs.uvs[i]);
+						}
+						return inputs.colors[g_NrElements / 2].g;
+					} });
+
+				//Parsing, the full OBJ import and the mesh cache path every later start takes
+				benchmarks.push_back({ "ObjImporter::Import", 1, [&inputs]()
+					{
+						ObjImporter::Import(g_MeshPath, MeshImportOptions{}, inputs.importedVertices, inputs.indices);
+						return static_cast<float>(inputs.importedVertices.size());
+					} });
+				benchmarks.push_back({ "Utils::SWParseOBJ", 1, [&inputs]()
+					{
+						AssetCache assets{};
+						Utils::SWParseOBJ(assets, g_MeshPath, inputs.parsedVertices, inputs.indices);
+						return static_cast<float>(inputs.parsedVertices.size());
+					} });
+
+				//Raster and pixel stage of one triangle, half of a square with sides of size pixels
+				for (const int size : { 8, 32, 128, 512 })
+				{
+					const int nrTriangles{ std::max(1, g_RasterPixelsPerBatch / (size * size / 2)) };
+					benchmarks.push_back({ "DrawTriangle " + std::to_string(size) + "px", nrTriangles, [&renderer, size, nrTriangles]()
+						{
+							const float sizePixels{ static_cast<float>(size) };
+							const Vector2 v0{ g_TriangleOffset, g_TriangleOffset };
+							const Vector2 v1{ g_TriangleOffset + sizePixels, g_TriangleOffset };
+							const Vector2 v2{ g_TriangleOffset, g_TriangleOffset + sizePixels };
+							for (int i{}; i < nrTriangles; ++i)
+							{
+								renderer.DrawBenchmarkTriangle(v0, v1, v2);
+							}
+							return sizePixels;
+						} });
+				}
+
+				//Pixel stage alone, every render mode is its own instantiation
+				benchmarks.push_back(CreatePixelShadingBenchmark<ObservedArea>("ObservedArea", inputs));
+				benchmarks.push_back(CreatePixelShadingBenchmark<Diffuse>("Diffuse", inputs));
+				benchmarks.push_back(CreatePixelShadingBenchmark<Specular>("Specular", inputs));
+				benchmarks.push_back(CreatePixelShadingBenchmark<Combined>("Combined", inputs));
+				return benchmarks;
+			}
+
+			Statistics Measure(const Benchmark& benchmark, const MicroBenchmarkOptions& options)
+			{
+				for (int repetition{}; repetition < options.nrWarmupRepetitions; ++repetition)
+				{
+					g_Sink = benchmark.run();
+				}
+
+				std::vector<double> nsPerOperation{};
+				nsPerOperation.reserve(options.nrRepetitions);
+				for (int repetition{}; repetition < options.nrRepetitions; ++repetition)
+				{
+					const uint64_t startNs{ Profiler::GetTimestampNs() };
+					g_Sink = benchmark.run();
+					const uint64_t endNs{ Profiler::GetTimestampNs() };
+					nsPerOperation.push_back(static_cast<double>(endNs - startNs) / benchmark.nrOperations);
+				}
+				std::sort(nsPerOperation.begin(), nsPerOperation.end());
+
+				Statistics statistics{};
+				const size_t middle{ nsPerOperation.size() / 2 };
+				statistics.medianNs = nsPerOperation.size() % 2 == 1 ? nsPerOperation[middle] : 0.5 * (nsPerOperation[middle - 1] + nsPerOperation[middle]);
+				statistics.minNs = nsPerOperation.front();
+
+				double sum{};
+				for (const double ns : nsPerOperation)
+				{
+					sum += ns;
+				}
+				const double mean{ sum / static_cast<double>(nsPerOperation.size()) };
+				double sqrDeviations{};
+				for (const double ns : nsPerOperation)
+				{
+					sqrDeviations += (ns - mean) * (ns - mean);
+				}
+				statistics.variationPercent = mean > 0. ? std::sqrt(sqrDeviations / static_cast<double>(nsPerOperation.size())) / mean * 100. : 0.;
+				return statistics;
+			}
+		}
+
+		bool IsRequested(int argc, char* args[])
+		{
+			return Utils::HasArgument(argc, args, "--microbench");
+		}
+
+		bool ParseArguments(int argc, char* args[], MicroBenchmarkOptions& options, std::string& error)
+		{
+			Utils::ArgumentReader arguments{ argc, args, error };
+			while (arguments.Next())
+			{
+				const std::string& argument{ arguments.GetCurrent() };
+				if (argument == "--microbench")
+					continue;
+
+				if (argument == "--update") { options.isUpdating = true; }
+				else if (argument == "--repetitions") { if (!arguments.TakeInt(1, options.nrRepetitions)) return false; }
+				else if (argument == "--warmup") { if (!arguments.TakeInt(0, options.nrWarmupRepetitions)) return false; }
+				else if (argument == "--tolerance") { if (!arguments.TakePercent(options.tolerancePercent)) return false; }
+				else if (argument == "--baseline") { if (!arguments.TakeValue(options.baselinePath, "a path")) return false; }
+				else if (argument == "--filter") { if (!arguments.TakeValue(options.filter)) return false; }
+				else
+				{
+					return arguments.SetUnknown();
+				}
+			}
+			return true;
+		}
+
+		void PrintUsage()
+		{
+			std::cerr << "Usage: DirectX --microbench [options]\n"
+				<< "  --update                    write the baselines of this machine\n"
+				<< "  --baseline PATH             median time per operation of every benchmark (MicroBenchmarks.csv)\n"
+				<< "  --filter TEXT               only benchmarks with TEXT in their name\n"
+				<< "  --repetitions N, --warmup N timed and untimed batches per benchmark (15, 3)\n"
+				<< "  --tolerance P               percent the median may be slower than the baseline (10)\n";
+		}
+
+		int Run(const MicroBenchmarkOptions& options)
+		{
+			//The raster benchmarks draw over one rendered frame, so the depth buffer is cleared and the light grid built
+			HeadlessScene scene{ g_RasterWidth, g_RasterHeight };
+			scene.RenderFrame(1.f / 60.f);
+
+			Inputs inputs{};
+			CreateInputs(inputs, scene.GetCamera());
+			const std::vector<Benchmark> benchmarks{ CreateBenchmarks(inputs, scene.GetRenderer()) };
+
+			Utils::Baselines baselines{ Utils::ReadBaselines(options.baselinePath) };
+
+			int nrBenchmarks{};
+			int nrFailed{};
+			std::cout << std::fixed << std::setprecision(2);
+			for (const Benchmark& benchmark : benchmarks)
+			{
+				if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos)
+					continue;
+
+				++nrBenchmarks;
+				const Statistics statistics{ Measure(benchmark, options) };
+
+				std::ostringstream result{};
+				result << std::fixed << std::setprecision(2) << "median " << statistics.medianNs << " ns, min " << statistics.minNs << " ns, variation " << statistics.variationPercent << '%';
+
+				if (options.isUpdating)
+				{
+					baselines[benchmark.name] = statistics.medianNs;
+					std::cout << "UPDATE " << benchmark.name << ": " << result.str() << '\n';
+					continue;
+				}
+
+				//Only slower than the baseline fails
+				bool isPassed{ false };
+				if (const auto it{ baselines.find(benchmark.name) }; it == baselines.end() || it->second <= 0.)
+				{
+					result << ", no baseline";
+				}
+				else
+				{
+					const double change{ (statistics.medianNs / it->second - 1.) * 100. };
+					isPassed = change <= options.tolerancePercent;
+					result << ", baseline " << it->second << " ns (" << std::showpos << change << std::noshowpos << "%)";
+				}
+
+				//The tolerance means little when the repetitions spread wider than it
+				if (statistics.variationPercent > options.tolerancePercent)
+				{
+					result << ", noisy";
+				}
+
+				if (!isPassed)
+				{
+					++nrFailed;
+				}
+				std::cout << (isPassed ? "PASS   " : "FAIL   ") << benchmark.name << ": " << result.str() << '\n';
+			}
+
+			if (options.isUpdating)
+			{
+				if (!Utils::WriteBaselines(options.baselinePath, g_BaselinesHeader, baselines))
+				{
+					std::cout << "Could not write " << options.baselinePath << '\n';
+					return 1;
+				}
+				std::cout << "Wrote " << nrBenchmarks << " baselines to " << options.baselinePath << '\n';
+				return 0;
+			}
+
+			std::cout << nrBenchmarks - nrFailed << '/' << nrBenchmarks << " benchmarks passed\n";
+			return nrFailed == 0 && nrBenchmarks > 0 ? 0 : 1;
+		}
+
+		int Run(int argc, char* args[])
+		{
+			MicroBenchmarkOptions options{};
+			std::string error{};
+			if (!ParseArguments(argc, args, options, error))
+			{
+				std::cerr << error << '\n';
+				PrintUsage();
+				return 2;
+			}
+			return Run(options);
+		}
+	}
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include <string>
+
+namespace dae
+{
+	struct MicroBenchmarkOptions
+	{
+		//Per benchmark, every repetition times one batch of operations
+		int nrWarmupRepetitions{ 3 };
+		int nrRepetitions{ 15 };
+
+		//benchmark,medianNs per line, the time of one operation
+		std::string baselinePath{ "MicroBenchmarks.csv" };
+		//Writes the baselines instead of comparing against them
+		bool isUpdating{ false };
+		//Only the benchmarks with this in their name, every benchmark when empty
+		std::string filter{};
+
+		//Slowdown of the median against the baseline that still passes, in percent
+		float tolerancePercent{ 10.f };
+	};
+
+	//The building blocks of the software renderer timed one at a time: vertex math, texture sampling, OBJ parsing,
+	//one triangle through the raster kernel and the vehicle pixel stage per render mode.
+	//Optimizations of a single kernel show up here long before they move the frame time of the whole scene.
+	namespace MicroBenchmarks
+	{
+		bool IsRequested(int argc, char* args[]);
+
+		bool ParseArguments(int argc, char* args[], MicroBenchmarkOptions& options, std::string& error);
+		void PrintUsage();
+
+		//Process exit code, 0 when no benchmark got slower than its baseline or the baselines were written
+		int Run(const MicroBenchmarkOptions& options);
+		int Run(int argc, char* args[]);
+	}
+}
@@ -0,0 +1,404 @@
+#include "pch.h"
+#include "ObjImporter.h"
+
+#include <charconv>
+#include <cstring>
+#include <future>
+#include <thread>
+#include <unordered_map>
+
+#include "MappedFile.h"
+#include "MeshOptimizer.h"
+
+namespace dae
+{
+	namespace ObjImporter
+	{
+		namespace
+		{
+			//Smaller files are not worth the thread start up
+			constexpr size_t g_MinChunkSize{ 256 * 1024 };
+
+			//Relative (negative) OBJ indices are resolved once the element count of the previous chunks is known
+			constexpr uint8_t g_RelativePosition{ 1 << 0 };
+			constexpr uint8_t g_RelativeUV{ 1 << 1 };
+			constexpr uint8_t g_RelativeNormal{ 1 << 2 };
+
+			//1-based like the file, 0 when the attribute is missing
+			struct FaceCorner
+			{
+				int64_t position{};
+				int64_t uv{};
+				int64_t normal{};
+				uint8_t relative{};
+			};
+
+			struct Chunk
+			{
+				const char* pBegin{ nullptr };
+				const char* pEnd{ nullptr };
+
+				std::vector<Vector3> positions{};
+				std::vector<Vector2> UVs{};
+				std::vector<Vector3> normals{};
+
+				//Three corners per triangle, in file winding
+				std::vector<FaceCorner> corners{};
+				bool isValid{ true };
+			};
+
+			//Runs function(begin, end) over [0, count) split into at most one range per core
+			template<typename Function>
+			void ParallelFor(size_t count, size_t minRangeSize, const Function& function)
+			{
+				const size_t maxTasks{ std::max<size_t>(std::thread::hardware_concurrency(), 1) };
+				const size_t nrTasks{ std::clamp<size_t>(count / std::max<size_t>(minRangeSize, 1), 1, maxTasks) };
+
+				std::vector<std::future<void>> tasks{};
+				tasks.reserve(nrTasks - 1);
+				for (size_t task{ 1 }; task < nrTasks; ++task)
+				{
+					tasks.push_back(std::async(std::launch::async, function, count * task / nrTasks, count * (task + 1) / nrTasks));
+				}
+				function(0, count / nrTasks);
+
+				for (std::future<void>& task : tasks)
+				{
+					task.get();
+				}
+			}
+
+			const char* SkipSpaces(const char* pCurrent, const char* pEnd)
+			{
+				while (pCurrent < pEnd && (*pCurrent == ' ' || *pCurrent == '\t'))
+					++pCurrent;
+				return pCurrent;
+			}
+
+			bool ParseFloat(const char*& pCurrent, const char* pEnd, float& value)
+			{
+				pCurrent = SkipSpaces(pCurrent, pEnd);
+				const auto [pNext, error] { std::from_chars(pCurrent, pEnd, value) };
+				pCurrent = pNext;
+				return error == std::errc{};
+			}
+
+			bool ParseIndex(const char*& pCurrent, const char* pEnd, int64_t& value)
+			{
+				const auto [pNext, error] { std::from_chars(pCurrent, pEnd, value) };
+				pCurrent = pNext;
+				return error == std::errc{} && value != 0;
+			}
+
+			//Makes a negative index relative to the start of the chunk, the chunk offset is added when merging
+			void ToChunkIndex(int64_t& index, size_t nrParsed, uint8_t relativeFlag, uint8_t& relative)
+			{
+				if (index < 0)
+				{
+					index += static_cast<int64_t>(nrParsed) + 1;
+					relative |= relativeFlag;
+				}
+			}
+
+			//position[/[uv][/normal]]
+			bool ParseCorner(const char*& pCurrent, const char* pEnd, const Chunk& chunk, FaceCorner& corner)
+			{
+				corner = {};
+				if (!ParseIndex(pCurrent, pEnd, corner.position))
+					return false;
+				ToChunkIndex(corner.position, chunk.positions.size(), g_RelativePosition, corner.relative);
+
+				if (pCurrent < pEnd && *pCurrent == '/')
+				{
+					++pCurrent;
+					if (pCurrent < pEnd && *pCurrent != '/')
+					{
+						if (!ParseIndex(pCurrent, pEnd, corner.uv))
+							return false;
+						ToChunkIndex(corner.uv, chunk.UVs.size(), g_RelativeUV, corner.relative);
+					}
+					if (pCurrent < pEnd && *pCurrent == '/')
+					{
+						++pCurrent;
+						if (!ParseIndex(pCurrent, pEnd, corner.normal))
+							return false;
+						ToChunkIndex(corner.normal, chunk.normals.size(), g_RelativeNormal, corner.relative);
+					}
+				}
+				return true;
+			}
+
+			void ParseChunk(Chunk& chunk)
+			{
+				std::vector<FaceCorner> face{};
+
+				const char* pLine{ chunk.pBegin };
+				while (pLine < chunk.pEnd)
+				{
+					const char* pLineEnd{ static_cast<const char*>(memchr(pLine, '\n', static_cast<size_t>(chunk.pEnd - pLine))) };
+					if (!pLineEnd)
+						pLineEnd = chunk.pEnd;
+
+					const char* pCurrent{ SkipSpaces(pLine, pLineEnd) };
+					const size_t length{ static_cast<size_t>(pLineEnd - pCurrent) };
+
+					if (length > 2 && pCurrent[0] == 'v' && (pCurrent[1] == ' ' || pCurrent[1] == '\t'))
+					{
+						pCurrent += 2;
+						Vector3& position{ chunk.positions.emplace_back() };
+						chunk.isValid &= ParseFloat(pCurrent, pLineEnd, position.x) && ParseFloat(pCurrent, pLineEnd, position.y) && ParseFloat(pCurrent, pLineEnd, position.z);
+					}
+					else if (length > 3 && pCurrent[0] == 'v' && pCurrent[1] == 't')
+					{
+						pCurrent += 2;
+						Vector2& uv{ chunk.UVs.emplace_back() };
+						chunk.isValid &= ParseFloat(pCurrent, pLineEnd, uv.x) && ParseFloat(pCurrent, pLineEnd, uv.y);
+						uv.y = 1 - uv.y;
+					}
+					else if (length > 3 && pCurrent[0] == 'v' && pCurrent[1] == 'n')
+					{
+						pCurrent += 2;
+						Vector3& normal{ chunk.normals.emplace_back() };
+						chunk.isValid &= ParseFloat(pCurrent, pLineEnd, normal.x) && ParseFloat(pCurrent, pLineEnd, normal.y) && ParseFloat(pCurrent, pLineEnd, normal.z);
+					}
+					else if (length > 2 && pCurrent[0] == 'f' && (pCurrent[1] == ' ' || pCurrent[1] == '\t'))
+					{
+						pCurrent += 2;
+						face.clear();
+						while (true)
+						{
+							pCurrent = SkipSpaces(pCurrent, pLineEnd);
+							if (pCurrent >= pLineEnd || *pCurrent == '\r' || *pCurrent == '#')
+								break;
+
+							FaceCorner& corner{ face.emplace_back() };
+							if (!ParseCorner(pCurrent, pLineEnd, chunk, corner))
+							{
+								chunk.isValid = false;
+								break;
+							}
+						}
+
+						//Fan triangulation, a triangle stays a single triangle
+						for (size_t i{ 2 }; i < face.size(); ++i)
+						{
+							chunk.corners.push_back(face[0]);
+							chunk.corners.push_back(face[i - 1]);
+							chunk.corners.push_back(face[i]);
+						}
+					}
+
+					pLine = pLineEnd + 1;
+				}
+			}
+
+			//Chunk boundaries are moved forward to the start of the next line
+			std::vector<Chunk> SplitIntoChunks(const char* pData, size_t size)
+			{
+				const size_t maxChunks{ std::max<size_t>(std::thread::hardware_concurrency(), 1) };
+				const size_t nrChunks{ std::clamp<size_t>(size / g_MinChunkSize, 1, maxChunks) };
+
+				std::vector<Chunk> chunks(nrChunks);
+				const char* pEnd{ pData + size };
+				const char* pBegin{ pData };
+				for (size_t i{}; i < nrChunks; ++i)
+				{
+					const char* pSplit{ i + 1 == nrChunks ? pEnd : pData + size * (i + 1) / nrChunks };
+					if (pSplit < pBegin)
+						pSplit = pBegin;
+
+					const char* pNewLine{ static_cast<const char*>(memchr(pSplit, '\n', static_cast<size_t>(pEnd - pSplit))) };
+					pSplit = pNewLine ? pNewLine + 1 : pEnd;
+
+					chunks[i].pBegin = pBegin;
+					chunks[i].pEnd = pSplit;
+					pBegin = pSplit;
+				}
+				return chunks;
+			}
+		}
+
+		bool Import(const std::string& filename, const MeshImportOptions& options, std::vector<MeshCache::CachedVertex>& vertices, std::vector<uint32_t>& indices)
+		{
+			vertices.clear();
+			indices.clear();
+
+			MappedFile file{ filename };
+			if (!file.IsValid())
+				return false;
+
+			//Parse every chunk on its own core
+			std::vector<Chunk> chunks{ SplitIntoChunks(file.GetData(), file.GetSize()) };
+			ParallelFor(chunks.size(), 1, [&chunks](size_t begin, size_t end)
+				{
+					for (size_t i{ begin }; i < end; ++i)
+					{
+						ParseChunk(chunks[i]);
+					}
+				});
+
+			//Element offsets of every chunk
+			std::vector<size_t> positionOffsets(chunks.size() + 1);
+			std::vector<size_t> uvOffsets(chunks.size() + 1);
+			std::vector<size_t> normalOffsets(chunks.size() + 1);
+			std::vector<size_t> cornerOffsets(chunks.size() + 1);
+			for (size_t i{}; i < chunks.size(); ++i)
+			{
+				if (!chunks[i].isValid)
+					return false;
+
+				positionOffsets[i + 1] = positionOffsets[i] + chunks[i].positions.size();
+				uvOffsets[i + 1] = uvOffsets[i] + chunks[i].UVs.size();
+				normalOffsets[i + 1] = normalOffsets[i] + chunks[i].normals.size();
+				cornerOffsets[i + 1] = cornerOffsets[i] + chunks[i].corners.size();
+			}
+
+			//Merge the attributes and resolve the corners against the merged arrays
+			std::vector<Vector3> positions(positionOffsets.back());
+			std::vector<Vector2> UVs(uvOffsets.back());
+			std::vector<Vector3> normals(normalOffsets.back());
+			std::vector<FaceCorner> corners(cornerOffsets.back());
+			ParallelFor(chunks.size(), 1, [&](size_t begin, size_t end)
+				{
+					for (size_t i{ begin }; i < end; ++i)
+					{
+						Chunk& chunk{ chunks[i] };
+						std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + positionOffsets[i]);
+						std::copy(chunk.UVs.begin(), chunk.UVs.end(), UVs.begin() + uvOffsets[i]);
+						std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + normalOffsets[i]);
+
+						for (size_t j{}; j < chunk.corners.size(); ++j)
+						{
+							FaceCorner corner{ chunk.corners[j] };
+							if (corner.relative & g_RelativePosition) corner.position += static_cast<int64_t>(positionOffsets[i]);
+							if (corner.relative & g_RelativeUV) corner.uv += static_cast<int64_t>(uvOffsets[i]);
+							if (corner.relative & g_RelativeNormal) corner.normal += static_cast<int64_t>(normalOffsets[i]);
+
+							const bool isInRange
+							{
+								corner.position >= 1 && corner.position <= static_cast<int64_t>(positions.size()) &&
+								corner.uv >= 0 && corner.uv <= static_cast<int64_t>(UVs.size()) &&
+								corner.normal >= 0 && corner.normal <= static_cast<int64_t>(normals.size())
+							};
+							if (!isInRange)
+								chunk.isValid = false;
+
+							corners[cornerOffsets[i] + j] = corner;
+						}
+
+						//Free the chunk memory early, the merged arrays can be large
+						chunk.positions = {};
+						chunk.UVs = {};
+						chunk.normals = {};
+						chunk.corners = {};
+					}
+				});
+			file.Unmap();
+
+			for (const Chunk& chunk : chunks)
+			{
+				if (!chunk.isValid)
+					return false;
+			}
+
+			//Face corners that reference the same position/uv/normal share one vertex, numbered in order of first use
+			std::unordered_map<ObjCorner, uint32_t, ObjCornerHash> welded{};
+			welded.reserve(corners.size() / 2);
+			vertices.reserve(corners.size() / 2);
+			indices.resize(corners.size());
+			for (size_t i{}; i < corners.size(); ++i)
+			{
+				const FaceCorner& corner{ corners[i] };
+				const auto [it, isNew] = welded.try_emplace(ObjCorner{ static_cast<size_t>(corner.position), static_cast<size_t>(corner.uv), static_cast<size_t>(corner.normal) }, static_cast<uint32_t>(vertices.size()));
+				if (isNew)
+				{
+					MeshCache::CachedVertex& vertex{ vertices.emplace_back() };
+					vertex.position = positions[corner.position - 1];
+					if (corner.uv) vertex.uv = UVs[corner.uv - 1];
+					if (corner.normal) vertex.normal = normals[corner.normal - 1];
+				}
+
+				//Swap the last two corners of every triangle to flip the winding
+				const size_t cornerIndex{ i % 3 };
+				const size_t target{ options.flipAxisAndWinding && cornerIndex != 0 ? i - cornerIndex + 3 - cornerIndex : i };
+				indices[target] = it->second;
+			}
+			corners.clear();
+			corners.shrink_to_fit();
+
+			//Cheap tangent calculations, one tangent per triangle
+			const size_t nrTriangles{ indices.size() / 3 };
+			std::vector<Vector3> triangleTangents(nrTriangles);
+			ParallelFor(nrTriangles, 16 * 1024, [&](size_t begin, size_t end)
+				{
+					for (size_t i{ begin }; i < end; ++i)
+					{
+						const MeshCache::CachedVertex& v0{ vertices[indices[i * 3]] };
+						const MeshCache::CachedVertex& v1{ vertices[indices[i * 3 + 1]] };
+						const MeshCache::CachedVertex& v2{ vertices[indices[i * 3 + 2]] };
+
+						const Vector3 edge0 = v1.position - v0.position;
+						const Vector3 edge1 = v2.position - v0.position;
+						const Vector2 diffX = Vector2(v1.uv.x - v0.uv.x, v2.uv.x - v0.uv.x);
+						const Vector2 diffY = Vector2(v1.uv.y - v0.uv.y, v2.uv.y - v0.uv.y);
+						const float r = 1.f / Vector2::Cross(diffX, diffY);
+
+						triangleTangents[i] = (edge0 * diffY.y - edge1 * diffY.x) * r;
+					}
+				});
+
+			//Triangles of every vertex (CSR: offsets into one list), filled in file order
+			std::vector<uint32_t> vertexTriangleOffsets(vertices.size() + 1);
+			for (const uint32_t index : indices)
+			{
+				++vertexTriangleOffsets[index + 1];
+			}
+			for (size_t i{ 1 }; i < vertexTriangleOffsets.size(); ++i)
+			{
+				vertexTriangleOffsets[i] += vertexTriangleOffsets[i - 1];
+			}
+			std::vector<uint32_t> vertexTriangles(indices.size());
+			{
+				std::vector<uint32_t> nextSlots(vertexTriangleOffsets.begin(), vertexTriangleOffsets.end() - 1);
+				for (size_t i{}; i < indices.size(); ++i)
+				{
+					vertexTriangles[nextSlots[indices[i]]++] = static_cast<uint32_t>(i / 3);
+				}
+			}
+
+			//Every task owns a vertex range and only reads the triangles of its vertices, in file order so the sums match a serial pass exactly
+			ParallelFor(vertices.size(), 64 * 1024, [&](size_t begin, size_t end)
+				{
+					for (size_t i{ begin }; i < end; ++i)
+					{
+						for (uint32_t slot{ vertexTriangleOffsets[i] }; slot < vertexTriangleOffsets[i + 1]; ++slot)
+						{
+							vertices[i].tangent += triangleTangents[vertexTriangles[slot]];
+						}
+					}
+
+					if (options.flipAxisAndWinding)
+					{
+						for (size_t i{ begin }; i < end; ++i)
+						{
+							vertices[i].position.z *= -1.f;
+							vertices[i].normal.z *= -1.f;
+							vertices[i].tangent.z *= -1.f;
+						}
+					}
+				});
+
+			//Vertex cache, overdraw and vertex fetch order, blended meshes keep the triangle order of the file
+			if (options.keepTriangleOrder)
+			{
+				MeshOptimizer::OptimizeVertexFetch(vertices, indices);
+			}
+			else
+			{
+				MeshOptimizer::Optimize(vertices, indices, [](const MeshCache::CachedVertex& v) { return v.position; });
+			}
+
+			return true;
+		}
+	}
+}
@@ -0,0 +1,16 @@
+#pragma once
+#include <string>
+#include <vector>
+
+#include "MeshCache.h"
+
+namespace dae
+{
+	//Memory mapped OBJ importer, the file is split at line boundaries and the chunks are parsed on all cores.
+	//One parse feeds both backends: AssetCache writes the result to the mesh cache and each backend converts it to its vertex type.
+	namespace ObjImporter
+	{
+		//Welded, optimized triangle list with accumulated (unnormalized) tangents, faces with more corners are fanned
+		bool Import(const std::string& filename, const MeshImportOptions& options, std::vector<MeshCache::CachedVertex>& vertices, std::vector<uint32_t>& indices);
+	}
+}
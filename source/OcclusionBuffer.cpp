@@ -0,0 +1,234 @@
+#include "pch.h"
+#include "OcclusionBuffer.h"
+#include "Camera.h"
+#include "Profiler.h"
+
+namespace dae
+{
+	namespace
+	{
+		//Keeps only the biggest triangles, dropping triangles can only open holes so the result never hides something that is visible
+		void BuildOccluder(GlobalMesh& globalMesh, const MeshData& mesh)
+		{
+			constexpr size_t maxOccluderTriangles{ 256 };
+
+			globalMesh.occluderVertices.clear();
+			globalMesh.occluderIndices.clear();
+
+			//Keep the triangles with the biggest area
+			const std::vector<MeshCache::CachedVertex>& vertices{ mesh.vertices };
+			const std::vector<uint32_t>& indices{ mesh.indices };
+			std::vector<std::pair<float, uint32_t>> triangles{};
+			triangles.reserve(indices.size() / 3);
+			for (uint32_t i{}; i + 2 < indices.size(); i += 3)
+			{
+				const Vector3& v0{ vertices[indices[i]].position };
+				const float area{ Vector3::Cross(vertices[indices[i + 1]].position - v0, vertices[indices[i + 2]].position - v0).SqrMagnitude() };
+				triangles.emplace_back(area, i);
+			}
+
+			const size_t nrTriangles{ std::min(triangles.size(), maxOccluderTriangles) };
+			std::partial_sort(triangles.begin(), triangles.begin() + static_cast<ptrdiff_t>(nrTriangles), triangles.end(),
+				[](const auto& a, const auto& b) { return a.first > b.first; });
+
+			//Only copy the vertices the kept triangles use
+			std::vector<uint32_t> remap(vertices.size(), UINT32_MAX);
+			for (size_t t{}; t < nrTriangles; ++t)
+			{
+				for (uint32_t corner{}; corner < 3; ++corner)
+				{
+					const uint32_t index{ indices[triangles[t].second + corner] };
+					if (remap[index] == UINT32_MAX)
+					{
+						remap[index] = static_cast<uint32_t>(globalMesh.occluderVertices.size());
+						globalMesh.occluderVertices.push_back(vertices[index].position);
+					}
+					globalMesh.occluderIndices.push_back(remap[index]);
+				}
+			}
+		}
+	}
+
+	void InitializeGlobalMesh(GlobalMesh& globalMesh, const MeshData& mesh, bool isOccluder)
+	{
+		if (globalMesh.isInitialized)
+		{
+			return;
+		}
+		globalMesh.isInitialized = true;
+
+		//The box comes with the mesh, the sphere is around the center of the box (tighter than the sphere around the box)
+		globalMesh.boundsMin = mesh.boundsMin;
+		globalMesh.boundsMax = mesh.boundsMax;
+		globalMesh.boundsCenter = (mesh.boundsMin + mesh.boundsMax) * 0.5f;
+		float sqrRadius{};
+		for (const MeshCache::CachedVertex& vertex : mesh.vertices)
+		{
+			sqrRadius = std::max(sqrRadius, (vertex.position - globalMesh.boundsCenter).SqrMagnitude());
+		}
+		globalMesh.boundsRadius = sqrtf(sqrRadius);
+
+		if (isOccluder)
+		{
+			BuildOccluder(globalMesh, mesh);
+		}
+	}
+
+	OcclusionBuffer::OcclusionBuffer()
+	{
+		m_Depth.resize(static_cast<size_t>(m_Width) * m_Height);
+	}
+
+	void OcclusionBuffer::CullMeshes(const std::vector<GlobalMesh*>& pGlobalMeshes, const Camera& camera)
+	{
+		PROFILE_ZONE("OcclusionCulling");
+
+		m_NrCulled = 0;
+		if (!m_IsEnabled)
+		{
+			for (GlobalMesh* pGlobalMesh : pGlobalMeshes)
+			{
+				pGlobalMesh->isVisible = true;
+			}
+			return;
+		}
+
+		m_Near = camera.nearC;
+
+		//Meshes outside the frustum neither occlude nor need a test
+		std::fill(m_Depth.begin(), m_Depth.end(), FLT_MAX);
+		for (GlobalMesh* pGlobalMesh : pGlobalMeshes)
+		{
+			pGlobalMesh->isVisible = camera.IsInFrustum(*pGlobalMesh);
+			if (pGlobalMesh->isVisible)
+			{
+				RasterizeOccluder(*pGlobalMesh, camera);
+			}
+		}
+
+		for (GlobalMesh* pGlobalMesh : pGlobalMeshes)
+		{
+			pGlobalMesh->isVisible = pGlobalMesh->isVisible && IsBoundingBoxVisible(*pGlobalMesh, camera);
+			if (!pGlobalMesh->isVisible)
+			{
+				++m_NrCulled;
+			}
+		}
+	}
+
+	void OcclusionBuffer::RasterizeOccluder(const GlobalMesh& globalMesh, const Camera& camera)
+	{
+		if (globalMesh.occluderIndices.empty())
+			return;
+
+		//Screen space xy, 1/w in z and view depth in w
+		const Matrix& worldViewProjectionMatrix{ globalMesh.GetWorldViewProjection(camera.viewProjectionMatrix, camera.viewProjectionVersion) };
+		m_ProjectedVertices.resize(globalMesh.occluderVertices.size());
+		for (size_t i{}; i < globalMesh.occluderVertices.size(); ++i)
+		{
+			const Vector4 projected{ worldViewProjectionMatrix.TransformPoint(Vector4{ globalMesh.occluderVertices[i], 1.f }) };
+			const float invW{ 1.f / projected.w };
+			m_ProjectedVertices[i] =
+			{
+				(projected.x * invW + 1.f) / 2.f * static_cast<float>(m_Width),
+				(1.f - projected.y * invW) / 2.f * static_cast<float>(m_Height),
+				invW,
+				projected.w
+			};
+		}
+
+		for (size_t i{}; i + 2 < globalMesh.occluderIndices.size(); i += 3)
+		{
+			const Vector4& v0{ m_ProjectedVertices[globalMesh.occluderIndices[i]] };
+			const Vector4& v1{ m_ProjectedVertices[globalMesh.occluderIndices[i + 1]] };
+			const Vector4& v2{ m_ProjectedVertices[globalMesh.occluderIndices[i + 2]] };
+
+			//Clipping would only add work, an occluder that crosses the near plane is skipped
+			if (v0.w < m_Near || v1.w < m_Near || v2.w < m_Near)
+				continue;
+
+			RasterizeTriangle(v0, v1, v2);
+		}
+	}
+
+	void OcclusionBuffer::RasterizeTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2)
+	{
+		const float area{ (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x) };
+		if (std::abs(area) < FLT_EPSILON)
+			return;
+		const float invArea{ 1.f / area };
+
+		const int minX{ std::max(static_cast<int>(std::min({ v0.x, v1.x, v2.x })), 0) };
+		const int minY{ std::max(static_cast<int>(std::min({ v0.y, v1.y, v2.y })), 0) };
+		const int maxX{ std::min(static_cast<int>(std::max({ v0.x, v1.x, v2.x })) + 1, m_Width) };
+		const int maxY{ std::min(static_cast<int>(std::max({ v0.y, v1.y, v2.y })) + 1, m_Height) };
+
+		for (int py{ minY }; py < maxY; ++py)
+		{
+			const float y{ static_cast<float>(py) + 0.5f };
+			for (int px{ minX }; px < maxX; ++px)
+			{
+				const float x{ static_cast<float>(px) + 0.5f };
+
+				//Barycentrics, the sign of the area takes care of both windings
+				const float weight0{ ((v1.x - x) * (v2.y - y) - (v1.y - y) * (v2.x - x)) * invArea };
+				const float weight1{ ((v2.x - x) * (v0.y - y) - (v2.y - y) * (v0.x - x)) * invArea };
+				const float weight2{ 1.f - weight0 - weight1 };
+				if (weight0 < 0.f || weight1 < 0.f || weight2 < 0.f)
+					continue;
+
+				const float depth{ 1.f / (weight0 * v0.z + weight1 * v1.z + weight2 * v2.z) };
+				float& storedDepth{ m_Depth[static_cast<size_t>(py) * m_Width + px] };
+				storedDepth = std::min(storedDepth, depth);
+			}
+		}
+	}
+
+	bool OcclusionBuffer::IsBoundingBoxVisible(const GlobalMesh& globalMesh, const Camera& camera) const
+	{
+		const Matrix& worldViewProjectionMatrix{ globalMesh.GetWorldViewProjection(camera.viewProjectionMatrix, camera.viewProjectionVersion) };
+
+		//Screen rectangle and nearest depth of the 8 corners
+		Vector2 minScreen{ FLT_MAX, FLT_MAX };
+		Vector2 maxScreen{ -FLT_MAX, -FLT_MAX };
+		float nearestDepth{ FLT_MAX };
+		for (int corner{}; corner < 8; ++corner)
+		{
+			const Vector3 position
+			{
+				(corner & 1) ? globalMesh.boundsMax.x : globalMesh.boundsMin.x,
+				(corner & 2) ? globalMesh.boundsMax.y : globalMesh.boundsMin.y,
+				(corner & 4) ? globalMesh.boundsMax.z : globalMesh.boundsMin.z
+			};
+			const Vector4 projected{ worldViewProjectionMatrix.TransformPoint(Vector4{ position, 1.f }) };
+
+			//The box reaches the camera, nothing can be in front of it
+			if (projected.w < m_Near)
+				return true;
+
+			const Vector2 screen
+			{
+				(projected.x / projected.w + 1.f) / 2.f * static_cast<float>(m_Width),
+				(1.f - projected.y / projected.w) / 2.f * static_cast<float>(m_Height)
+			};
+			minScreen = Vector2::Min(minScreen, screen);
+			maxScreen = Vector2::Max(maxScreen, screen);
+			nearestDepth = std::min(nearestDepth, projected.w);
+		}
+
+		//Every pixel the box touches, visible as soon as one of them is farther than the box
+		const int minX{ std::max(static_cast<int>(floorf(minScreen.x)), 0) };
+		const int minY{ std::max(static_cast<int>(floorf(minScreen.y)), 0) };
+		const int maxX{ std::min(static_cast<int>(ceilf(maxScreen.x)), m_Width) };
+		const int maxY{ std::min(static_cast<int>(ceilf(maxScreen.y)), m_Height) };
+		for (int py{ minY }; py < maxY; ++py)
+		{
+			for (int px{ minX }; px < maxX; ++px)
+			{
+				if (m_Depth[static_cast<size_t>(py) * m_Width + px] >= nearestDepth)
+					return true;
+			}
+		}
+		return false;
+	}
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "Math.h"
+#include "AssetCache.h"
+#include "GlobalDefinitions.h"
+
+namespace dae
+{
+	struct Camera;
+
+	//Bounds and occluder of a mesh from its imported data, both backends cull with them.
+	//The first renderer that loads the mesh fills them, later calls keep what is there.
+	//Transparent meshes don't hide anything and get no occluder.
+	void InitializeGlobalMesh(GlobalMesh& globalMesh, const MeshData& mesh, bool isOccluder);
+
+	//Low resolution depth only buffer, the occluders of every mesh are rasterized on the CPU
+	//and the bounding box of every mesh is tested against it before either backend draws.
+	class OcclusionBuffer final
+	{
+	public:
+		OcclusionBuffer();
+
+		//Sets GlobalMesh::isVisible for every mesh
+		void CullMeshes(const std::vector<GlobalMesh*>& pGlobalMeshes, const Camera& camera);
+
+		void ToggleEnabled()
+		{
+			m_IsEnabled = !m_IsEnabled;
+			if (m_IsEnabled) { std::cout << "ON"; }
+			else { std::cout << "OFF"; }
+		}
+		void SetEnabled(bool isEnabled) { m_IsEnabled = isEnabled; }
+		bool IsEnabled() const { return m_IsEnabled; }
+		int GetNrCulled() const { return m_NrCulled; }
+
+	private:
+		static constexpr int m_Width{ 256 };
+		static constexpr int m_Height{ 128 };
+
+		//Linear view depth per pixel
+		std::vector<float> m_Depth{};
+		std::vector<Vector4> m_ProjectedVertices{};
+
+		float m_Near{};
+		int m_NrCulled{};
+		bool m_IsEnabled{ true };
+
+		void RasterizeOccluder(const GlobalMesh& globalMesh, const Camera& camera);
+		void RasterizeTriangle(const Vector4& v0, const Vector4& v1, const Vector4& v2);
+		bool IsBoundingBoxVisible(const GlobalMesh& globalMesh, const Camera& camera) const;
+	};
+}
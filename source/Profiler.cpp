@@ -0,0 +1,141 @@
+#include "pch.h"
+#include "Profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+namespace dae
+{
+	namespace Profiler
+	{
+		namespace
+		{
+			//Per thread, a long capture keeps the most recent zones
+			constexpr size_t g_EventsPerThread{ 1 << 16 };
+
+			struct Event
+			{
+				const char* pName{};
+				uint64_t startNs{};
+				uint64_t endNs{};
+			};
+
+			//Written by its own thread only, the export reads up to nrWritten
+			struct ThreadBuffer
+			{
+				uint32_t threadId{};
+				std::string name{};
+				std::vector<Event> events = std::vector<Event>(g_EventsPerThread);
+				std::atomic<uint64_t> nrWritten{};
+			};
+
+			//The only lock, taken once per thread and by capture start and end
+			std::mutex g_BuffersMutex{};
+			std::vector<std::unique_ptr<ThreadBuffer>> g_pBuffers{};
+			uint64_t g_CaptureStartNs{};
+
+			thread_local ThreadBuffer* t_pBuffer{ nullptr };
+
+			ThreadBuffer& GetThreadBuffer()
+			{
+				if (!t_pBuffer)
+				{
+					//Buffers are never freed, a thread that exits keeps its zones for the export
+					const std::lock_guard lock{ g_BuffersMutex };
+					g_pBuffers.push_back(std::make_unique<ThreadBuffer>());
+					t_pBuffer = g_pBuffers.back().get();
+					t_pBuffer->threadId = static_cast<uint32_t>(g_pBuffers.size());
+					t_pBuffer->name = "Thread " + std::to_string(t_pBuffer->threadId);
+				}
+				return *t_pBuffer;
+			}
+
+			void WriteEscaped(std::ofstream& file, const std::string& text)
+			{
+				for (const char character : text)
+				{
+					if (character == '"' || character == '\\')
+					{
+						file << '\\';
+					}
+					file << character;
+				}
+			}
+		}
+
+		uint64_t GetTimestampNs()
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+		}
+
+		void Record(const char* pName, uint64_t startNs, uint64_t endNs)
+		{
+			ThreadBuffer& buffer{ GetThreadBuffer() };
+			const uint64_t index{ buffer.nrWritten.load(std::memory_order_relaxed) };
+			buffer.events[index % g_EventsPerThread] = { pName, startNs, endNs };
+			buffer.nrWritten.store(index + 1, std::memory_order_release);
+		}
+
+		void SetThreadName(const std::string& name)
+		{
+			ThreadBuffer& buffer{ GetThreadBuffer() };
+			const std::lock_guard lock{ g_BuffersMutex };
+			buffer.name = name;
+		}
+
+		void BeginCapture()
+		{
+			const std::lock_guard lock{ g_BuffersMutex };
+			for (const auto& pBuffer : g_pBuffers)
+			{
+				pBuffer->nrWritten.store(0, std::memory_order_relaxed);
+			}
+			g_CaptureStartNs = GetTimestampNs();
+			g_IsCapturing.store(true, std::memory_order_release);
+		}
+
+		size_t EndCapture(const std::string& path)
+		{
+			g_IsCapturing.store(false, std::memory_order_release);
+
+			const std::lock_guard lock{ g_BuffersMutex };
+			std::ofstream file{ path, std::ios::trunc };
+			if (!file)
+				return 0;
+
+			//Complete events in microseconds from the start of the capture, one lane per thread
+			size_t nrEvents{};
+			file << std::fixed << std::setprecision(3);
+			file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+			const char* pSeparator{ "\n" };
+			for (const auto& pBuffer : g_pBuffers)
+			{
+				file << pSeparator << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << pBuffer->threadId << ",\"args\":{\"name\":\"";
+				WriteEscaped(file, pBuffer->name);
+				file << "\"}}";
+				pSeparator = ",\n";
+
+				//A zone that closes during the export can only overwrite the oldest slot, so a full ring skips it
+				const uint64_t nrWritten{ pBuffer->nrWritten.load(std::memory_order_acquire) };
+				const uint64_t first{ nrWritten > g_EventsPerThread ? nrWritten - g_EventsPerThread + 1 : 0 };
+				for (uint64_t i{ first }; i < nrWritten; ++i)
+				{
+					const Event& event{ pBuffer->events[i % g_EventsPerThread] };
+					if (event.startNs < g_CaptureStartNs)
+						continue;
+
+					file << ",\n{\"name\":\"";
+					WriteEscaped(file, event.pName);
+					file << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << pBuffer->threadId
+						<< ",\"ts\":" << static_cast<double>(event.startNs - g_CaptureStartNs) / 1000.0
+						<< ",\"dur\":" << static_cast<double>(event.endNs - event.startNs) / 1000.0 << '}';
+					++nrEvents;
+				}
+			}
+			file << "\n]}\n";
+			return nrEvents;
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace dae
+{
+	//Scoped CPU zones, every thread writes its own ring buffer without locks.
+	//A capture is exported as Chrome trace JSON, open it in chrome://tracing or ui.perfetto.dev.
+	//Define DISABLE_PROFILING to compile every PROFILE_ZONE out.
+	namespace Profiler
+	{
+		inline std::atomic<bool> g_IsCapturing{ false };
+
+		inline bool IsCapturing() { return g_IsCapturing.load(std::memory_order_relaxed); }
+
+		uint64_t GetTimestampNs();
+		void Record(const char* pName, uint64_t startNs, uint64_t endNs);
+
+		//Shown as the name of the lane of the calling thread
+		void SetThreadName(const std::string& name);
+
+		void BeginCapture();
+		//Stops recording and writes every zone since BeginCapture, returns the number of zones written
+		size_t EndCapture(const std::string& path);
+
+		//Only records when a capture was running for the whole zone, the name has to outlive the capture
+		class Zone final
+		{
+		public:
+			explicit Zone(const char* pName)
+				: m_pName{ pName }
+				, m_IsRecording{ IsCapturing() }
+				, m_StartNs{ m_IsRecording ? GetTimestampNs() : 0 }
+			{
+			}
+
+			~Zone()
+			{
+				if (m_IsRecording && IsCapturing())
+				{
+					Record(m_pName, m_StartNs, GetTimestampNs());
+				}
+			}
+
+			Zone(const Zone&) = delete;
+			Zone(Zone&&) noexcept = delete;
+			Zone& operator=(const Zone&) = delete;
+			Zone& operator=(Zone&&) noexcept = delete;
+
+		private:
+			const char* m_pName;
+			bool m_IsRecording;
+			uint64_t m_StartNs;
+		};
+	}
+}
+
+#if defined(DISABLE_PROFILING)
+#define PROFILE_ZONE(name)
+#else
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) const ::dae::Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__){ name }
+#endif
@@ -0,0 +1,152 @@
+#pragma once
+#include <bit>
+#include <cstdint>
+
+#include "Math.h"
+#include "DataTypes.h"
+
+namespace dae
+{
+	//20 byte vertex shared by both backends:
+	//position R16G16B16A16_UNORM in the mesh box, normal and tangent R16G16_SNORM octahedral, uv R16G16_FLOAT
+	struct QuantizedVertex
+	{
+		uint16_t position[4]{};
+		int16_t normal[2]{};
+		int16_t tangent[2]{};
+		uint16_t uv[2]{};
+	};
+	static_assert(sizeof(QuantizedVertex) == 20, "QuantizedVertex has to match the hardware input layout");
+
+	//position = offset + unorm * scale
+	struct QuantizationBounds
+	{
+		Vector3 offset{};
+		Vector3 scale{};
+	};
+
+	namespace Quantization
+	{
+		inline uint16_t FloatToHalf(float value)
+		{
+			const uint32_t bits{ std::bit_cast<uint32_t>(value) };
+			const uint16_t sign{ static_cast<uint16_t>((bits >> 16) & 0x8000) };
+			const int32_t exponent{ static_cast<int32_t>((bits >> 23) & 0xFF) - 127 + 15 };
+			uint32_t mantissa{ bits & 0x7FFFFF };
+
+			if (exponent >= 31)
+				return static_cast<uint16_t>(sign | 0x7C00); //Too big (or nan), clamp to infinity
+			if (exponent <= 0)
+			{
+				if (exponent < -10)
+					return sign;
+
+				//Denormal, shift in the implicit one
+				mantissa |= 0x800000;
+				const uint32_t shift{ static_cast<uint32_t>(14 - exponent) };
+				return static_cast<uint16_t>(sign | ((mantissa + (1u << (shift - 1))) >> shift));
+			}
+
+			//Round to nearest, a carry out of the mantissa correctly bumps the exponent
+			return static_cast<uint16_t>(sign | ((static_cast<uint32_t>(exponent) << 10) + ((mantissa + 0x1000) >> 13)));
+		}
+
+		inline float HalfToFloat(uint16_t value)
+		{
+			const uint32_t sign{ static_cast<uint32_t>(value & 0x8000) << 16 };
+			const uint32_t exponent{ static_cast<uint32_t>(value >> 10) & 0x1Fu };
+			const uint32_t mantissa{ value & 0x3FFu };
+
+			if (exponent == 0)
+			{
+				//Zero or denormal
+				const float magnitude{ static_cast<float>(mantissa) * (1.f / 16777216.f) };
+				return sign ? -magnitude : magnitude;
+			}
+			if (exponent == 31)
+				return std::bit_cast<float>(sign | 0x7F800000 | (mantissa << 13));
+
+			return std::bit_cast<float>(sign | ((exponent + 127 - 15) << 23) | (mantissa << 13));
+		}
+
+		inline int16_t FloatToSnorm16(float value)
+		{
+			return static_cast<int16_t>(roundf(Clamp(value, -1.f, 1.f) * 32767.f));
+		}
+
+		inline float Snorm16ToFloat(int16_t value)
+		{
+			return std::max(static_cast<float>(value) / 32767.f, -1.f);
+		}
+
+		//Unit vector to the octahedron, folded into [-1, 1]^2
+		inline Vector2 OctahedralEncode(const Vector3& v)
+		{
+			const float length{ std::abs(v.x) + std::abs(v.y) + std::abs(v.z) };
+			if (length <= 0.f)
+				return { 0.f, 0.f };
+
+			Vector2 encoded{ v.x / length, v.y / length };
+			if (v.z < 0.f)
+			{
+				const Vector2 folded{ encoded };
+				encoded.x = (1.f - std::abs(folded.y)) * (folded.x >= 0.f ? 1.f : -1.f);
+				encoded.y = (1.f - std::abs(folded.x)) * (folded.y >= 0.f ? 1.f : -1.f);
+			}
+			return encoded;
+		}
+
+		inline Vector3 OctahedralDecode(float x, float y)
+		{
+			Vector3 decoded{ x, y, 1.f - std::abs(x) - std::abs(y) };
+			const float fold{ Saturate(-decoded.z) };
+			decoded.x += decoded.x >= 0.f ? -fold : fold;
+			decoded.y += decoded.y >= 0.f ? -fold : fold;
+			return decoded.Normalized();
+		}
+
+		inline QuantizationBounds CalculateBounds(const Vector3& boundsMin, const Vector3& boundsMax)
+		{
+			return { boundsMin, boundsMax - boundsMin };
+		}
+
+		inline QuantizedVertex Encode(const Vector3& position, const Vector3& normal, const Vector3& tangent, const Vector2& uv, const QuantizationBounds& bounds)
+		{
+			const auto toUnorm16 = [](float value, float offset, float scale)
+			{
+				return static_cast<uint16_t>(scale > 0.f ? roundf(Saturate((value - offset) / scale) * 65535.f) : 0.f);
+			};
+
+			const Vector2 octNormal{ OctahedralEncode(normal) };
+			const Vector2 octTangent{ OctahedralEncode(tangent) };
+
+			QuantizedVertex vertex{};
+			vertex.position[0] = toUnorm16(position.x, bounds.offset.x, bounds.scale.x);
+			vertex.position[1] = toUnorm16(position.y, bounds.offset.y, bounds.scale.y);
+			vertex.position[2] = toUnorm16(position.z, bounds.offset.z, bounds.scale.z);
+			vertex.position[3] = 65535;
+			vertex.normal[0] = FloatToSnorm16(octNormal.x);
+			vertex.normal[1] = FloatToSnorm16(octNormal.y);
+			vertex.tangent[0] = FloatToSnorm16(octTangent.x);
+			vertex.tangent[1] = FloatToSnorm16(octTangent.y);
+			vertex.uv[0] = FloatToHalf(uv.x);
+			vertex.uv[1] = FloatToHalf(uv.y);
+			return vertex;
+		}
+
+		//Software vertex stage input, the attributes the stages don't read are left at their default
+		inline void Decode(const QuantizedVertex& vertex, const QuantizationBounds& bounds, Vertex_In& output)
+		{
+			constexpr float invUnorm16{ 1.f / 65535.f };
+			output.position =
+			{
+				bounds.offset.x + static_cast<float>(vertex.position[0]) * invUnorm16 * bounds.scale.x,
+				bounds.offset.y + static_cast<float>(vertex.position[1]) * invUnorm16 * bounds.scale.y,
+				bounds.offset.z + static_cast<float>(vertex.position[2]) * invUnorm16 * bounds.scale.z
+			};
+			output.normal = OctahedralDecode(Snorm16ToFloat(vertex.normal[0]), Snorm16ToFloat(vertex.normal[1]));
+			output.tangent = OctahedralDecode(Snorm16ToFloat(vertex.tangent[0]), Snorm16ToFloat(vertex.tangent[1]));
+			output.uv = { HalfToFloat(vertex.uv[0]), HalfToFloat(vertex.uv[1]) };
+		}
+	}
+}
@@ -0,0 +1,304 @@
+#include "pch.h"
+#include "RegressionSuite.h"
+#include "BenchmarkUtils.h"
+#include "HeadlessScene.h"
+#include "FrameHistory.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+
+namespace dae
+{
+	namespace RegressionSuite
+	{
+		namespace
+		{
+			struct Scenario
+			{
+				const char* pName{};
+				RenderMode renderMode{ Combined };
+				CullMode cullMode{ Back };
+				bool isNormal{ true };
+				bool isDepthBuffer{ false };
+				bool isMultisampled{ false };
+				int nrLights{};
+			};
+
+			//Add a scenario for every new rasterizer path and commit the golden that --update writes for it
+			constexpr Scenario g_Scenarios[]
+			{
+				{ "Combined" },
+				{ "ObservedArea", ObservedArea },
+				{ "Diffuse", Diffuse },
+				{ "Specular", Specular },
+				{ "CullFront", Combined, Front },
+				{ "CullNone", Combined, None },
+				{ "NoNormalMap", Combined, Back, false },
+				{ "DepthBuffer", Combined, Back, true, true },
+				{ "Multisampled", Combined, Back, true, false, true },
+				{ "Lights16", Combined, Back, true, false, false, 16 }
+			};
+
+			//Fixed view for every scenario, the vehicle turned so the fire and both sides are in the frame
+			constexpr Vector3 g_CameraOrigin{ 0.f, 0.f, 10.f };
+			constexpr float g_VehicleRotation{ 1.f };
+
+			constexpr const char* g_BaselinesFile{ "Baselines.csv" };
+			constexpr const char* g_BaselinesHeader{ "scenario,p50Ns" };
+
+			//Decoded goldens can be 24 or 32 bit
+			void GetPixelRGB(const SDL_Surface* pSurface, int x, int y, uint8_t& r, uint8_t& g, uint8_t& b)
+			{
+				const uint8_t* pPixel{ static_cast<const uint8_t*>(pSurface->pixels) + static_cast<ptrdiff_t>(y) * pSurface->pitch + static_cast<ptrdiff_t>(x) * pSurface->format->BytesPerPixel };
+				uint32_t pixel{};
+				std::memcpy(&pixel, pPixel, pSurface->format->BytesPerPixel);
+				SDL_GetRGB(pixel, pSurface->format, &r, &g, &b);
+			}
+
+			struct ImageDifference
+			{
+				int maxDifference{};
+				int nrDifferentPixels{};
+			};
+
+			ImageDifference CompareImages(const SDL_Surface* pActual, const SDL_Surface* pGolden, int pixelTolerance)
+			{
+				ImageDifference difference{};
+				for (int y{}; y < pActual->h; ++y)
+				{
+					for (int x{}; x < pActual->w; ++x)
+					{
+						uint8_t actual[3]{}, golden[3]{};
+						GetPixelRGB(pActual, x, y, actual[0], actual[1], actual[2]);
+						GetPixelRGB(pGolden, x, y, golden[0], golden[1], golden[2]);
+
+						int pixelDifference{};
+						for (int channel{}; channel < 3; ++channel)
+						{
+							pixelDifference = std::max(pixelDifference, std::abs(actual[channel] - golden[channel]));
+						}
+						difference.maxDifference = std::max(difference.maxDifference, pixelDifference);
+						if (pixelDifference > pixelTolerance)
+						{
+							++difference.nrDifferentPixels;
+						}
+					}
+				}
+				return difference;
+			}
+
+			//Renders the warmup and timed frames of one scenario, returns the median frame time
+			uint64_t RenderScenario(HeadlessScene& scene, const Scenario& scenario, const RegressionOptions& options)
+			{
+				SoftwareRenderSettings settings{};
+				settings.renderMode = scenario.renderMode;
+				settings.isNormal = scenario.isNormal;
+				settings.isDepthBuffer = scenario.isDepthBuffer;
+				settings.isMultisampled = scenario.isMultisampled;
+				scene.ApplySettings(settings);
+				scene.SetCullMode(scenario.cullMode);
+				scene.GetRenderer().ClearLights();
+				scene.AddLights(scenario.nrLights);
+
+				FrameHistory frameHistory{ static_cast<size_t>(options.nrFrames) };
+				uint64_t totalNs{};
+				for (int frame{}; frame < options.nrWarmupFrames + options.nrFrames; ++frame)
+				{
+					const uint64_t frameTimeNs{ scene.RenderFrame(1.f / 60.f) };
+					if (frame >= options.nrWarmupFrames)
+					{
+						totalNs += frameTimeNs;
+						frameHistory.Add(totalNs, frameTimeNs);
+					}
+				}
+				return frameHistory.Calculate().p50Ns;
+			}
+		}
+
+		bool IsRequested(int argc, char* args[])
+		{
+			return Utils::HasArgument(argc, args, "--regression");
+		}
+
+		bool ParseArguments(int argc, char* args[], RegressionOptions& options, std::string& error)
+		{
+			Utils::ArgumentReader arguments{ argc, args, error };
+			while (arguments.Next())
+			{
+				const std::string& argument{ arguments.GetCurrent() };
+				if (argument == "--regression")
+					continue;
+
+				if (argument == "--update") { options.isUpdating = true; }
+				else if (argument == "--width") { if (!arguments.TakeInt(1, options.width)) return false; }
+				else if (argument == "--height") { if (!arguments.TakeInt(1, options.height)) return false; }
+				else if (argument == "--frames") { if (!arguments.TakeInt(1, options.nrFrames)) return false; }
+				else if (argument == "--warmup") { if (!arguments.TakeInt(0, options.nrWarmupFrames)) return false; }
+				else if (argument == "--pixel-tolerance") { if (!arguments.TakeInt(0, options.pixelTolerance)) return false; }
+				else if (argument == "--max-different-pixels") { if (!arguments.TakePercent(options.maxDifferentPixelsPercent)) return false; }
+				else if (argument == "--time-tolerance") { if (!arguments.TakePercent(options.timeTolerancePercent)) return false; }
+				else if (argument == "--directory") { if (!arguments.TakeValue(options.directory)) return false; }
+				else if (argument == "--filter") { if (!arguments.TakeValue(options.filter)) return false; }
+				else
+				{
+					return arguments.SetUnknown();
+				}
+			}
+			return true;
+		}
+
+		void PrintUsage()
+		{
+			std::cerr << "Usage: DirectX --regression [options]\n"
+				<< "  --update                    write the golden images and the timing baselines of this machine,\n"
+				<< "                              without it missing baselines are recorded from scenarios whose image passes\n"
+				<< "  --directory PATH            goldens and Baselines.csv (" REGRESSION_DIRECTORY ")\n"
+				<< "  --filter TEXT               only scenarios with TEXT in their name\n"
+				<< "  --width N, --height N       render resolution (640x480), has to match the goldens\n"
+				<< "  --frames N, --warmup N      timed and untimed frames per scenario (20, 3)\n"
+				<< "  --pixel-tolerance N         largest channel difference of a matching pixel (8)\n"
+				<< "  --max-different-pixels P    percent of pixels allowed over the tolerance (0.1)\n"
+				<< "  --time-tolerance P          percent the median frame time may be slower than the baseline (15)\n";
+		}
+
+		int Run(const RegressionOptions& options)
+		{
+			std::error_code fileError{};
+			std::filesystem::create_directories(options.directory, fileError);
+			const std::filesystem::path directory{ options.directory };
+			const std::string baselinesPath{ (directory / g_BaselinesFile).string() };
+
+			HeadlessScene scene{ options.width, options.height };
+			scene.SetVehicleRotation(g_VehicleRotation);
+			Camera& camera{ scene.GetCamera() };
+			camera.origin = g_CameraOrigin;
+			camera.UpdateMatrices();
+
+			Utils::Baselines baselines{ Utils::ReadBaselines(baselinesPath) };
+			const int maxDifferentPixels{ static_cast<int>(options.maxDifferentPixelsPercent * 0.01f * static_cast<float>(options.width * options.height)) };
+
+			int nrScenarios{};
+			int nrFailed{};
+			int nrNewBaselines{};
+			std::cout << std::fixed << std::setprecision(2);
+			for (const Scenario& scenario : g_Scenarios)
+			{
+				const std::string name{ scenario.pName };
+				if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+					continue;
+
+				++nrScenarios;
+				const uint64_t p50Ns{ RenderScenario(scene, scenario, options) };
+				const double p50Ms{ static_cast<double>(p50Ns) * 1e-6 };
+				SDL_Surface* pFrame{ const_cast<SDL_Surface*>(scene.GetRenderer().GetFrontBuffer()) };
+				const std::string goldenPath{ (directory / (name + ".png")).string() };
+
+				if (options.isUpdating)
+				{
+					baselines[name] = static_cast<double>(p50Ns);
+					if (IMG_SavePNG(pFrame, goldenPath.c_str()) != 0)
+					{
+						std::cout << "FAIL   " << name << ": could not write " << goldenPath << '\n';
+						++nrFailed;
+						continue;
+					}
+					std::cout << "UPDATE " << name << ": " << p50Ms << " ms\n";
+					continue;
+				}
+
+				//Image, a missing or differently sized golden fails the scenario
+				std::ostringstream imageResult{};
+				bool isImagePassed{ false };
+				SDL_Surface* pGolden{ IMG_Load(goldenPath.c_str()) };
+				if (!pGolden)
+				{
+					imageResult << "no golden image";
+				}
+				else if (pGolden->w != pFrame->w || pGolden->h != pFrame->h)
+				{
+					imageResult << "golden is " << pGolden->w << 'x' << pGolden->h;
+				}
+				else
+				{
+					const ImageDifference difference{ CompareImages(pFrame, pGolden, options.pixelTolerance) };
+					isImagePassed = difference.nrDifferentPixels <= maxDifferentPixels;
+					imageResult << difference.nrDifferentPixels << " pixels over tolerance (max difference " << difference.maxDifference << ')';
+				}
+				SDL_FreeSurface(pGolden);
+
+				if (!isImagePassed)
+				{
+					const std::string actualPath{ (directory / (name + "_actual.png")).string() };
+					IMG_SavePNG(pFrame, actualPath.c_str());
+				}
+
+				//Timing, only slower than the baseline fails.
+				//Baselines are machine-local, the first run on a machine records them as long as the image is right.
+				std::ostringstream timeResult{};
+				timeResult << std::fixed << std::setprecision(2) << p50Ms << " ms";
+				bool isTimePassed{ false };
+				if (const auto it{ baselines.find(name) }; it == baselines.end() || it->second <= 0.)
+				{
+					if (isImagePassed)
+					{
+						baselines[name] = static_cast<double>(p50Ns);
+						isTimePassed = true;
+						++nrNewBaselines;
+						timeResult << ", new baseline";
+					}
+					else
+					{
+						timeResult << ", no baseline";
+					}
+				}
+				else
+				{
+					const double change{ (static_cast<double>(p50Ns) / it->second - 1.) * 100. };
+					isTimePassed = change <= options.timeTolerancePercent;
+					timeResult << " vs " << it->second * 1e-6 << " ms (" << std::showpos << change << std::noshowpos << "%)";
+				}
+
+				const bool isPassed{ isImagePassed && isTimePassed };
+				if (!isPassed)
+				{
+					++nrFailed;
+				}
+				std::cout << (isPassed ? "PASS   " : "FAIL   ") << name << ": image " << imageResult.str() << ", time " << timeResult.str() << '\n';
+			}
+
+			if (options.isUpdating)
+			{
+				if (!Utils::WriteBaselines(baselinesPath, g_BaselinesHeader, baselines))
+				{
+					std::cout << "Could not write " << baselinesPath << '\n';
+					return 1;
+				}
+				std::cout << "Wrote " << nrScenarios - nrFailed << " goldens and the baselines to " << options.directory << '\n';
+				return nrFailed == 0 ? 0 : 1;
+			}
+
+			if (nrNewBaselines > 0 && !Utils::WriteBaselines(baselinesPath, g_BaselinesHeader, baselines))
+			{
+				std::cout << "Could not write " << baselinesPath << '\n';
+				return 1;
+			}
+
+			std::cout << nrScenarios - nrFailed << '/' << nrScenarios << " scenarios passed\n";
+			return nrFailed == 0 && nrScenarios > 0 ? 0 : 1;
+		}
+
+		int Run(int argc, char* args[])
+		{
+			RegressionOptions options{};
+			std::string error{};
+			if (!ParseArguments(argc, args, options, error))
+			{
+				std::cerr << error << '\n';
+				PrintUsage();
+				return 2;
+			}
+			return Run(options);
+		}
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+
+//Goldens are committed in source/Regression, Visual Studio runs from source/ and the CMake build passes the absolute path
+#ifndef REGRESSION_DIRECTORY
+#define REGRESSION_DIRECTORY "Regression"
+#endif
+
+namespace dae
+{
+	struct RegressionOptions
+	{
+		int width{ 640 };
+		int height{ 480 };
+		//Per scenario, the median of the timed frames is compared against the baseline
+		int nrWarmupFrames{ 3 };
+		int nrFrames{ 20 };
+
+		//Golden images <scenario>.png and Baselines.csv, the frame of a failed image check is written next to them.
+		//The goldens are committed, Baselines.csv stays on the machine that wrote it.
+		std::string directory{ REGRESSION_DIRECTORY };
+		//Writes the goldens and baselines instead of comparing against them
+		bool isUpdating{ false };
+		//Only the scenarios with this in their name, every scenario when empty
+		std::string filter{};
+
+		//Largest difference of one color channel (0-255) that still counts as the same pixel
+		int pixelTolerance{ 8 };
+		//Share of the pixels that may differ by more than pixelTolerance, in percent
+		float maxDifferentPixelsPercent{ 0.1f };
+		//Slowdown of the median frame time against the baseline that still passes, in percent
+		float timeTolerancePercent{ 15.f };
+	};
+
+	//Fixed scenarios through the software renderer: every render mode, every cull mode, normal map off and the depth buffer.
+	//A scenario fails when its frame differs from the golden image or when its median frame time is slower than the baseline,
+	//so a slower rasterizer fails the same way a visual change does. Baselines only mean something on the machine that wrote them,
+	//so the first run on a machine records them.
+	namespace RegressionSuite
+	{
+		bool IsRequested(int argc, char* args[]);
+
+		bool ParseArguments(int argc, char* args[], RegressionOptions& options, std::string& error);
+		void PrintUsage();
+
+		//Process exit code, 0 when every scenario passed or the references were written
+		int Run(const RegressionOptions& options);
+		int Run(int argc, char* args[]);
+	}
+}
@@ -5,6 +5,10 @@ Texture2D gGlossinessMap : GlossinessMap;
 
 
 float4x4 gWorldViewProj : WorldViewPorjection;
+
+//Quantized vertices, position = offset + unorm * scale
+float3 gPositionOffset : PositionOffset;
+float3 gPositionScale : PositionScale;
 float4x4 gWorldMatrix : WorldMatrix;
 float4x4 gViewInverseMatrix : ViewInverseMatrix;
 
@@ -54,6 +58,14 @@ struct VS_INPUT
 	float2 UV : TEXCOORD;
 };
 
+struct VS_INPUT_QUANTIZED
+{
+	float4 Position : POSITION;
+	float2 Normal : NORMAL;
+	float2 Tangent : TANGENT;
+	float2 UV : TEXCOORD;
+};
+
 struct VS_OUTPUT
 {
 	float4 Position : SV_POSITION;
@@ -77,6 +89,24 @@ VS_OUTPUT VS(VS_INPUT input)
 	return output;
 }
 
+float3 OctahedralDecode(float2 encoded)
+{
+	float3 decoded = float3(encoded, 1.f - abs(encoded.x) - abs(encoded.y));
+	const float fold = saturate(-decoded.z);
+	decoded.xy += (decoded.xy >= 0.f) ? -fold : fold;
+	return normalize(decoded);
+}
+
+VS_OUTPUT VS_Quantized(VS_INPUT_QUANTIZED input)
+{
+	VS_INPUT decoded;
+	decoded.Position = gPositionOffset + input.Position.xyz * gPositionScale;
+	decoded.Normal = OctahedralDecode(input.Normal);
+	decoded.Tangent = OctahedralDecode(input.Tangent);
+	decoded.UV = input.UV;
+	return VS(decoded);
+}
+
 //-------------------------
 //	Pixel Shader
 //-------------------------
@@ -127,4 +157,17 @@ technique11 DefaultTechnique
 		SetGeometryShader(NULL);
 		SetPixelShader(CompileShader(ps_5_0, PS()));
 	}
-}
\ No newline at end of file
+}
+
+technique11 QuantizedTechnique
+{
+	pass P0
+	{
+		SetRasterizerState(gRasterizerState);
+		SetDepthStencilState(gDepthStencilState, 0);
+		SetBlendState(gBlendState, float4(0.0f, 0.0f, 0.0f, 0.0f), 0xFFFFFFFF);
+		SetVertexShader(CompileShader(vs_5_0, VS_Quantized()));
+		SetGeometryShader(NULL);
+		SetPixelShader(CompileShader(ps_5_0, PS()));
+	}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define SOFTWARE_BLEND_SSE2
+#endif
+
+namespace dae
+{
+	namespace Blend
+	{
+		//dst = src * alpha + dst * (1 - alpha), per 8 bit channel (matches SrcBlend = src_alpha, DestBlend = inv_src_alpha)
+		inline uint32_t BlendPixel(uint32_t src, uint32_t dst, uint32_t alpha)
+		{
+			uint32_t result{};
+			for (uint32_t shift{}; shift < 32; shift += 8)
+			{
+				const uint32_t s{ (src >> shift) & 0xFF };
+				const uint32_t d{ (dst >> shift) & 0xFF };
+				uint32_t x{ s * alpha + d * (255 - alpha) + 128 };
+				x = (x + (x >> 8)) >> 8;
+				result |= x << shift;
+			}
+			return result;
+		}
+
+		//Blends a row of pixels, alpha 0 leaves the destination untouched.
+		//The alpha is cleared on the way, so the span can be filled again without a separate clear.
+		inline void BlendSpan(uint32_t* pDst, const uint32_t* pSrc, uint8_t* pAlpha, int count)
+		{
+			int i{};
+#ifdef SOFTWARE_BLEND_SSE2
+			const __m128i zero{ _mm_setzero_si128() };
+			const __m128i max{ _mm_set1_epi16(255) };
+			const __m128i half{ _mm_set1_epi16(128) };
+			for (; i + 4 <= count; i += 4)
+			{
+				if ((pAlpha[i] | pAlpha[i + 1] | pAlpha[i + 2] | pAlpha[i + 3]) == 0)
+					continue;
+
+				const __m128i src{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + i)) };
+				const __m128i dst{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pDst + i)) };
+
+				//Alpha of each pixel replicated over its 4 channels
+				const __m128i alphaLow{ _mm_set_epi16(pAlpha[i + 1], pAlpha[i + 1], pAlpha[i + 1], pAlpha[i + 1], pAlpha[i], pAlpha[i], pAlpha[i], pAlpha[i]) };
+				const __m128i alphaHigh{ _mm_set_epi16(pAlpha[i + 3], pAlpha[i + 3], pAlpha[i + 3], pAlpha[i + 3], pAlpha[i + 2], pAlpha[i + 2], pAlpha[i + 2], pAlpha[i + 2]) };
+
+				const auto blend = [&](__m128i s, __m128i d, __m128i a)
+				{
+					__m128i x{ _mm_add_epi16(_mm_mullo_epi16(s, a), _mm_mullo_epi16(d, _mm_sub_epi16(max, a))) };
+					x = _mm_add_epi16(x, half);
+					return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+				};
+
+				const __m128i low{ blend(_mm_unpacklo_epi8(src, zero), _mm_unpacklo_epi8(dst, zero), alphaLow) };
+				const __m128i high{ blend(_mm_unpackhi_epi8(src, zero), _mm_unpackhi_epi8(dst, zero), alphaHigh) };
+
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), _mm_packus_epi16(low, high));
+				pAlpha[i] = pAlpha[i + 1] = pAlpha[i + 2] = pAlpha[i + 3] = 0;
+			}
+#endif
+			for (; i < count; ++i)
+			{
+				if (pAlpha[i] == 0)
+					continue;
+
+				pDst[i] = BlendPixel(pSrc[i], pDst[i], pAlpha[i]);
+				pAlpha[i] = 0;
+			}
+		}
+	}
+}
@@ -0,0 +1,256 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <type_traits>
+#include <variant>
+
+#include "Math.h"
+#include "DataTypes.h"
+#include "GlobalDefinitions.h"
+#include "LightGrid.h"
+#include "Meshlet.h"
+#include "QuantizedVertex.h"
+#include "SoftwareTexture.h"
+
+namespace dae
+{
+	//Per draw constants shared by every software effect (mirrors the globals in Vehicle.fx)
+	struct ShaderGlobals
+	{
+		Matrix worldMatrix{};
+		Matrix worldViewProjectionMatrix{};
+		Vector3 cameraOrigin{};
+
+		Vector3 lightDirection{ 0.577f, -0.577f, 0.577f };
+		float lightIntensity{ 7.f };
+		ColorRGB ambientColor{ 0.025f, 0.025f, 0.025f };
+
+		//Point and spot lights, nullptr when the scene only has the directional light
+		const LightGrid* pLightGrid{ nullptr };
+	};
+
+	//Screen position and view depth of the pixel being shaded
+	struct Fragment
+	{
+		int x{};
+		int y{};
+		float viewDepth{};
+	};
+
+	//Tag that carries the shading toggles into the pixel stage at compile time
+	template<bool isNormal, RenderMode renderMode>
+	struct ShadingKernel final {};
+
+	//A software effect is a vertex stage and a pixel stage that agree on one interpolant layout.
+	//The rasterizer is instantiated per effect, so both stages get inlined into the raster loop.
+	//Vertex stages only write the varyings, the renderer transforms the positions with worldViewProjectionMatrix in SoA batches.
+	template<typename VertexStage, typename PixelStage>
+	struct SoftwareEffect final
+	{
+		using Varyings = typename PixelStage::Varyings;
+		static_assert(std::is_same_v<typename VertexStage::Varyings, Varyings>, "Vertex and pixel stage need the same interpolant layout");
+		static_assert(std::is_trivially_copyable_v<Varyings> && sizeof(Varyings) % sizeof(float) == 0, "Varyings can only contain floats");
+
+		static constexpr bool IsTransparent{ PixelStage::IsTransparent };
+
+		VertexStage vertexStage{};
+		PixelStage pixelStage{};
+	};
+
+	//Perspective correct interpolation over every float of the interpolant layout
+	template<typename Varyings>
+	MATH_INLINE Varyings InterpolateVaryings(const Varyings& v0, const Varyings& v1, const Varyings& v2, float weight0, float weight1, float weight2)
+	{
+		constexpr size_t nrFloats{ sizeof(Varyings) / sizeof(float) };
+		using FloatArray = std::array<float, nrFloats>;
+
+		const FloatArray a0{ std::bit_cast<FloatArray>(v0) };
+		const FloatArray a1{ std::bit_cast<FloatArray>(v1) };
+		const FloatArray a2{ std::bit_cast<FloatArray>(v2) };
+
+		FloatArray result;
+		for (size_t i{}; i < nrFloats; ++i)
+		{
+			result[i] = a0[i] * weight0 + a1[i] * weight1 + a2[i] * weight2;
+		}
+		return std::bit_cast<Varyings>(result);
+	}
+
+	/* --- VEHICLE --- */
+	struct VehicleVaryings
+	{
+		Vector2 uv{};
+		Vector3 normal{};
+		Vector3 tangent{};
+		Vector3 viewDirection{};
+	};
+
+	struct VehicleVertexStage final
+	{
+		using Varyings = VehicleVaryings;
+
+		void operator()(const Vertex_In& vertex, const ShaderGlobals& globals, Varyings& output) const
+		{
+			output.uv = vertex.uv;
+			output.normal = globals.worldMatrix.TransformVector(vertex.normal).Normalized<ShadingPrecision>();
+			output.tangent = globals.worldMatrix.TransformVector(vertex.tangent).Normalized<ShadingPrecision>();
+			output.viewDirection = globals.worldMatrix.TransformPoint(vertex.position) - globals.cameraOrigin;
+		}
+	};
+
+	struct VehiclePixelStage final
+	{
+		using Varyings = VehicleVaryings;
+		static constexpr bool IsTransparent{ false };
+
+		const SoftwareTexture* pDiffuse{ nullptr };
+		const SoftwareTexture* pNormal{ nullptr };
+		const SoftwareTexture* pSpecular{ nullptr };
+		const SoftwareTexture* pGloss{ nullptr };
+
+		float shininess{ 25.f };
+		float kd{ 1.f };
+
+		template<bool isNormal, RenderMode renderMode>
+		MATH_INLINE ColorRGB operator()(const Varyings& v, const ShaderGlobals& globals, const Fragment& fragment, ShadingKernel<isNormal, renderMode>) const
+		{
+			const Vector3 normal{ v.normal.Normalized<ShadingPrecision>() };
+			Vector3 sampledNormal{ normal };
+
+			if constexpr (isNormal)
+			{
+				const Vector3 tangent{ v.tangent.Normalized<ShadingPrecision>() };
+				const Vector3 binormal = Vector3::Cross(normal, tangent);
+				const Matrix tangentSpaceAxis = { tangent, binormal, normal, Vector3::Zero };
+
+				sampledNormal = pNormal->SampleToVector(v.uv);
+				sampledNormal = 2.f * sampledNormal - Vector3::One;
+				sampledNormal = tangentSpaceAxis.TransformVector(sampledNormal);
+
+				sampledNormal.Normalize<ShadingPrecision>();
+			}
+
+			ColorRGB diffuseColor{};
+			if constexpr (renderMode == Diffuse || renderMode == Combined)
+			{
+				diffuseColor = pDiffuse->Sample(v.uv) * kd / PI;
+			}
+
+			//Directional light
+			ColorRGB finalColor{ Shade<renderMode>(sampledNormal, globals.lightDirection, colors::White, globals.lightIntensity, 1.f, diffuseColor, v) };
+
+			//Only the lights assigned to the cluster of this fragment
+			if (globals.pLightGrid)
+			{
+				const Vector3 worldPosition{ globals.cameraOrigin + v.viewDirection };
+				for (const uint32_t lightIndex : globals.pLightGrid->GetLightIndices(fragment.x, fragment.y, fragment.viewDepth))
+				{
+					const Light& light{ globals.pLightGrid->GetLight(lightIndex) };
+
+					Vector3 lightDirection{ worldPosition - light.position };
+					const float distance{ lightDirection.Normalize<ShadingPrecision>() };
+					const float attenuation{ light.GetAttenuation(distance, lightDirection) };
+					if (attenuation <= 0.f)
+						continue;
+
+					finalColor += Shade<renderMode>(sampledNormal, lightDirection, light.color, light.intensity * attenuation, attenuation, diffuseColor, v);
+				}
+			}
+
+			return finalColor + globals.ambientColor;
+		}
+
+	private:
+		//Lambert + phong for one light, intensity scales diffuse and attenuation scales specular
+		template<RenderMode renderMode>
+		MATH_INLINE ColorRGB Shade(const Vector3& sampledNormal, const Vector3& lightDirection, const ColorRGB& lightColor, float intensity, float attenuation, const ColorRGB& diffuseColor, const Varyings& v) const
+		{
+			const float observedArea = Vector3::DotClamp(sampledNormal, -lightDirection);
+
+			if constexpr (renderMode == ObservedArea)
+			{
+				return lightColor * observedArea * attenuation;
+			}
+			else if constexpr (renderMode == Diffuse)
+			{
+				return lightColor * diffuseColor * intensity * observedArea;
+			}
+			else if constexpr (renderMode == Specular)
+			{
+				return lightColor * CalculateSpecular(sampledNormal, lightDirection, v) * observedArea * attenuation;
+			}
+			else
+			{
+				return lightColor * (diffuseColor * intensity * observedArea + CalculateSpecular(sampledNormal, lightDirection, v) * attenuation);
+			}
+		}
+
+		MATH_INLINE ColorRGB CalculateSpecular(const Vector3& sampledNormal, const Vector3& lightDirection, const Varyings& v) const
+		{
+			const Vector3 reflectDirection{ Vector3::Reflect(lightDirection, sampledNormal) };
+
+			const float cosAngle = Vector3::DotClamp(reflectDirection, -v.viewDirection.Normalized<ShadingPrecision>());
+
+			const float glossExponent{ pGloss->Sample(v.uv).r * shininess };
+
+			const float phong{ ShadingPrecision::Pow(cosAngle, glossExponent) };
+
+			return pSpecular->Sample(v.uv) * phong;
+		}
+	};
+
+	using VehicleEffect = SoftwareEffect<VehicleVertexStage, VehiclePixelStage>;
+
+	/* --- FIRE --- */
+	struct FireVaryings
+	{
+		Vector2 uv{};
+	};
+
+	struct FireVertexStage final
+	{
+		using Varyings = FireVaryings;
+
+		void operator()(const Vertex_In& vertex, const ShaderGlobals&, Varyings& output) const
+		{
+			output.uv = vertex.uv;
+		}
+	};
+
+	struct FirePixelStage final
+	{
+		using Varyings = FireVaryings;
+		static constexpr bool IsTransparent{ true };
+
+		const SoftwareTexture* pDiffuse{ nullptr };
+
+		template<bool isNormal, RenderMode renderMode>
+		MATH_INLINE ColorRGB operator()(const Varyings& v, const ShaderGlobals&, const Fragment&, ShadingKernel<isNormal, renderMode>) const
+		{
+			return pDiffuse->SampleRGBA(v.uv);
+		}
+	};
+
+	using FireEffect = SoftwareEffect<FireVertexStage, FirePixelStage>;
+
+	//Every effect a software mesh can be bound to, add custom materials here
+	using SoftwareEffectVariant = std::variant<VehicleEffect, FireEffect>;
+
+	struct SoftwareMesh final
+	{
+		Mesh mesh{};
+		SoftwareEffectVariant effect{};
+		const Matrix* pWorldMatrix{ nullptr };
+		const GlobalMesh* pGlobalMesh{ nullptr };
+
+		std::vector<Meshlet> meshlets{};
+		std::vector<uint32_t> meshletVertices{};
+
+		//Replaces mesh.vertices when the mesh is quantized
+		std::vector<QuantizedVertex> quantizedVertices{};
+		QuantizationBounds quantizationBounds{};
+
+		bool IsQuantized() const { return !quantizedVertices.empty(); }
+		size_t GetNrVertices() const { return IsQuantized() ? quantizedVertices.size() : mesh.vertices.size(); }
+	};
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <SDL_pixels.h>
+
+#include "MathConfig.h"
+
+namespace dae
+{
+	//Channel layout of a 32 bit surface, copied out of SDL_PixelFormat once so the raster loop packs and unpacks pixels without calling into SDL.
+	//Gives the same values as SDL_MapRGB and SDL_GetRGBA for 8 bit channels.
+	class PixelFormat final
+	{
+	public:
+		PixelFormat() = default;
+		explicit PixelFormat(const SDL_PixelFormat& format)
+			: m_RMask{ format.Rmask }, m_GMask{ format.Gmask }, m_BMask{ format.Bmask }, m_AMask{ format.Amask }
+			, m_RShift{ format.Rshift }, m_GShift{ format.Gshift }, m_BShift{ format.Bshift }, m_AShift{ format.Ashift }
+			, m_RLoss{ format.Rloss }, m_GLoss{ format.Gloss }, m_BLoss{ format.Bloss }, m_ALoss{ format.Aloss }
+		{
+		}
+
+		//Alpha is opaque when the format has an alpha channel
+		MATH_INLINE uint32_t MapRGB(uint8_t r, uint8_t g, uint8_t b) const
+		{
+			return static_cast<uint32_t>(r >> m_RLoss) << m_RShift | static_cast<uint32_t>(g >> m_GLoss) << m_GShift | static_cast<uint32_t>(b >> m_BLoss) << m_BShift | m_AMask;
+		}
+
+		MATH_INLINE void GetRGB(uint32_t pixel, uint8_t& r, uint8_t& g, uint8_t& b) const
+		{
+			r = GetChannel(pixel, m_RMask, m_RShift, m_RLoss);
+			g = GetChannel(pixel, m_GMask, m_GShift, m_GLoss);
+			b = GetChannel(pixel, m_BMask, m_BShift, m_BLoss);
+		}
+
+		//Formats without alpha are opaque
+		MATH_INLINE void GetRGBA(uint32_t pixel, uint8_t& r, uint8_t& g, uint8_t& b, uint8_t& a) const
+		{
+			GetRGB(pixel, r, g, b);
+			a = m_AMask ? GetChannel(pixel, m_AMask, m_AShift, m_ALoss) : uint8_t{ 255 };
+		}
+
+	private:
+		MATH_INLINE static uint8_t GetChannel(uint32_t pixel, uint32_t mask, uint8_t shift, uint8_t loss)
+		{
+			return static_cast<uint8_t>(((pixel & mask) >> shift) << loss);
+		}
+
+		uint32_t m_RMask{}, m_GMask{}, m_BMask{}, m_AMask{};
+		uint8_t m_RShift{}, m_GShift{}, m_BShift{}, m_AShift{};
+		uint8_t m_RLoss{}, m_GLoss{}, m_BLoss{}, m_ALoss{};
+	};
+}
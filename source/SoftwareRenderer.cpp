@@ -1,301 +1,836 @@
 #include "pch.h"
 #include "SoftwareRenderer.h"
 #include "SWUtils.h"
+#include "SoftwareBlend.h"
+#include "OcclusionBuffer.h"
+#include "Profiler.h"
 
-SoftwareRenderer::SoftwareRenderer(SDL_Window* pWindow, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode)
+#include <iomanip>
+#include <numeric>
+
+namespace
+{
+	//4x MSAA, rotated grid sample positions relative to the pixel corner
+	constexpr int g_NrSamples{ 4 };
+	constexpr uint32_t g_FullCoverageMask{ (1u << g_NrSamples) - 1 };
+	constexpr float g_SampleOffsets[g_NrSamples][2]
+	{
+		{ 0.375f, 0.125f },
+		{ 0.875f, 0.375f },
+		{ 0.125f, 0.625f },
+		{ 0.625f, 0.875f }
+	};
+	constexpr int g_MultisampleTileSize{ 8 };
+
+	//Variable rate shading, one rate per tile: bit 0 shares shading over 2 columns, bit 1 over 2 rows
+	constexpr int g_ShadingRateTileSize{ 16 };
+	constexpr uint8_t g_ShadingRateFull{ 0 };
+	constexpr uint8_t g_ShadingRateCoarseX{ 1 << 0 };
+	constexpr uint8_t g_ShadingRateCoarseY{ 1 << 1 };
+	//Mean luminance step between neighbours (0-255) below which a tile gets shaded at half rate
+	constexpr float g_ShadingRateThreshold{ 2.5f };
+	//A coarse axis hides the contrast it was picked for, so every tile goes back to full rate once per this many frames to be measured again
+	constexpr int g_ShadingRateRefreshInterval{ 8 };
+
+	//Vertices whose positions go through one batched SoA transform
+	constexpr size_t g_TransformBatchSize{ 64 };
+
+	int GetWindowWidth(SDL_Window* pWindow)
+	{
+		int width{};
+		SDL_GetWindowSize(pWindow, &width, nullptr);
+		return width;
+	}
+
+	int GetWindowHeight(SDL_Window* pWindow)
+	{
+		int height{};
+		SDL_GetWindowSize(pWindow, nullptr, &height);
+		return height;
+	}
+}
+
+SoftwareRenderer::SoftwareRenderer(SDL_Window* pWindow, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode, AssetCache* pAssetCache)
+	: SoftwareRenderer(pWindow, GetWindowWidth(pWindow), GetWindowHeight(pWindow), pGlobalMeshes, pCamera, pCullMode, pAssetCache)
+{
+}
+
+SoftwareRenderer::SoftwareRenderer(int width, int height, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode, AssetCache* pAssetCache)
+	: SoftwareRenderer(nullptr, width, height, pGlobalMeshes, pCamera, pCullMode, pAssetCache)
+{
+}
+
+SoftwareRenderer::SoftwareRenderer(SDL_Window* pWindow, int width, int height, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode, AssetCache* pAssetCache)
 	: m_pWindow(pWindow)
-	, m_pTexture{ SoftwareTexture::LoadFromFile("Resources/vehicle_diffuse.png") }
-	, m_pTextureNormal{ SoftwareTexture::LoadFromFile("Resources/vehicle_normal.png") }
-	, m_pTextureSpecular{ SoftwareTexture::LoadFromFile("Resources/vehicle_specular.png") }
-	, m_pTextureGloss{ SoftwareTexture::LoadFromFile("Resources/vehicle_gloss.png") }
+	, m_IsOffscreen{ pWindow == nullptr }
+	, m_pTexture{ SoftwareTexture::LoadFromFile(*pAssetCache, "Resources/vehicle_diffuse.png") }
+	, m_pTextureNormal{ SoftwareTexture::LoadFromFile(*pAssetCache, "Resources/vehicle_normal.png") }
+	, m_pTextureSpecular{ SoftwareTexture::LoadFromFile(*pAssetCache, "Resources/vehicle_specular.png") }
+	, m_pTextureGloss{ SoftwareTexture::LoadFromFile(*pAssetCache, "Resources/vehicle_gloss.png") }
+	, m_pTextureFire{ SoftwareTexture::LoadFromFile(*pAssetCache, "Resources/fireFX_diffuse.png") }
 	, m_pGlobalMeshes{ pGlobalMeshes }
 	, m_pCamera{ pCamera }
 	, m_pCullMode{ pCullMode }
+	, m_pAssetCache{ pAssetCache }
 {
 	//Initialize
-	SDL_GetWindowSize(pWindow, &m_Width, &m_Height);
+	m_MaxWidth = width;
+	m_MaxHeight = height;
+	m_Width = m_MaxWidth;
+	m_Height = m_MaxHeight;
 
-	//Create Buffers
-	m_pFrontBuffer = SDL_GetWindowSurface(pWindow);
+	//Create Buffers, the render resolution is packed at the start of the back buffer
+	m_pFrontBuffer = m_IsOffscreen ? SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0) : SDL_GetWindowSurface(pWindow);
 	m_pBackBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
 	m_pBackBufferPixels = static_cast<uint32_t*>(m_pBackBuffer->pixels);
+	m_BackBufferFormat = PixelFormat{ *m_pBackBuffer->format };
+	m_pUpscaleBuffer = SDL_CreateRGBSurface(0, m_Width, m_Height, 32, 0, 0, 0, 0);
+	m_pDynamicResolution = new DynamicResolution{ m_Width, m_Height };
+	m_pFrameCapture = new FrameCapture{};
+	m_UpscaleTaps.resize(m_Width);
+
+	m_NrShadingRateTilesX = (m_Width + g_ShadingRateTileSize - 1) / g_ShadingRateTileSize;
+	m_NrShadingRateTiles = m_NrShadingRateTilesX * ((m_Height + g_ShadingRateTileSize - 1) / g_ShadingRateTileSize);
+	m_pShadingRates = new uint8_t[m_NrShadingRateTiles]{};
+	m_pCoarseShades = new CoarseShade[m_Width]{};
 
 	m_pDepthBufferPixels = new float[m_Width * m_Height];
+	m_pLightGrid = new LightGrid{ m_Width, m_Height };
+	m_pBlendSpanColors = new uint32_t[m_Width];
+	m_pBlendSpanAlpha = new uint8_t[m_Width]{};
+
+	m_NrMultisampleTilesX = (m_Width + g_MultisampleTileSize - 1) / g_MultisampleTileSize;
+	m_pSampleDepthBuffer = new float[m_Width * m_Height * g_NrSamples];
+	m_pSampleColorBuffer = new uint32_t[m_Width * m_Height * g_NrSamples];
+	m_pPixelCompressed = new uint8_t[m_Width * m_Height];
+	m_pTileDecompressed = new uint8_t[m_NrMultisampleTilesX * ((m_Height + g_MultisampleTileSize - 1) / g_MultisampleTileSize)];
+
+	//Bind the vehicle textures to its effect
+	VehicleEffect vehicleEffect{};
+	vehicleEffect.pixelStage.pDiffuse = m_pTexture;
+	vehicleEffect.pixelStage.pNormal = m_pTextureNormal;
+	vehicleEffect.pixelStage.pSpecular = m_pTextureSpecular;
+	vehicleEffect.pixelStage.pGloss = m_pTextureGloss;
+	LoadMesh("Resources/vehicle.obj", m_pGlobalMeshes[0], vehicleEffect);
+
+	FireEffect fireEffect{};
+	fireEffect.pixelStage.pDiffuse = m_pTextureFire;
+	LoadMesh("Resources/fireFX.obj", m_pGlobalMeshes[1], fireEffect);
 
-	LoadMesh("Resources/vehicle.obj");
+	//Set values for matrix
+	constexpr Vector3 translation = { Vector3{ 0.0f, 0.f, 50.f } };
+	constexpr Vector3 rotation = { 0.f, 0.f, 0.f };
+	constexpr Vector3 scale = { 1.f, 1.f, 1.f };
+
+	//Generate and apply matrix, evaluated at compile time
+	constexpr Matrix worldMatrix{ Matrix::CreateScale(scale) * Matrix::CreateRotation(rotation) * Matrix::CreateTranslation(translation) };
+	for (const auto pgMesh : m_pGlobalMeshes)
+	{
+		pgMesh->SetWorldMatrix(worldMatrix);
+	}
 
 	//Reserve max size
 	const size_t reserveSize = FindReserveSize();
-	m_VerticesCount = reserveSize;
-	m_VerticesNDC = new Vertex_In[reserveSize];
-	m_VerticesWorld = new Vertex_In[reserveSize];
-	m_VerticesScreenSpace = new Vector2[reserveSize];
+	m_VerticesProjected.resize(reserveSize);
 }
 
 SoftwareRenderer::~SoftwareRenderer()
 {
 	delete[] m_pDepthBufferPixels;
-	delete[] m_VerticesNDC;
-	delete[] m_VerticesWorld;
-	delete[] m_VerticesScreenSpace;
+	delete m_pLightGrid;
+	delete[] m_pBlendSpanColors;
+	delete[] m_pBlendSpanAlpha;
+	delete[] m_pSampleDepthBuffer;
+	delete[] m_pSampleColorBuffer;
+	delete[] m_pPixelCompressed;
+	delete[] m_pTileDecompressed;
+	delete m_pDynamicResolution;
+	delete m_pFrameCapture;
+	delete[] m_pShadingRates;
+	delete[] m_pCoarseShades;
+	SDL_FreeSurface(m_pUpscaleBuffer);
+	SDL_FreeSurface(m_pBackBuffer);
+	if (m_IsOffscreen)
+	{
+		SDL_FreeSurface(m_pFrontBuffer);
+	}
+	for (const auto pMesh : m_pMeshes)
+	{
+		delete pMesh;
+	}
 	delete m_pTexture;
 	delete m_pTextureGloss;
 	delete m_pTextureNormal;
 	delete m_pTextureSpecular;
+	delete m_pTextureFire;
 }
 
-void SoftwareRenderer::Update(const Timer* pTimer) const
+void SoftwareRenderer::Update(float elapsedSec)
 {
+	PROFILE_ZONE("Software::Update");
+
+	if (m_IsDynamicResolution && m_pDynamicResolution->Update(elapsedSec))
+	{
+		SetRenderResolution(m_pDynamicResolution->GetWidth(), m_pDynamicResolution->GetHeight());
+	}
+
 	if (m_IsRotating)
 	{
 		for (const auto pgMesh : m_pGlobalMeshes)
 		{
 			constexpr float rotationSpeed = 1.f;
-			*pgMesh->pWorldMatrix = Matrix::CreateRotationY((rotationSpeed * pTimer->GetElapsed())) * *pgMesh->pWorldMatrix;
+			pgMesh->SetWorldMatrix(Matrix::CreateRotationY((rotationSpeed * elapsedSec)) * *pgMesh->pWorldMatrix);
 		}
 	}
 }
 
 void SoftwareRenderer::Render()
 {
-	//Clears background
-	if (m_ClearColor)
-	{
-		SDL_FillRect(m_pBackBuffer, nullptr, SDL_MapRGB(m_pBackBuffer->format, 26, 26, 26));
-	}
-	else
-	{
-		SDL_FillRect(m_pBackBuffer, nullptr, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
-	}
-	
+	PROFILE_ZONE("Software::Render");
+
 	//Lock BackBuffer
 	SDL_LockSurface(m_pBackBuffer);
 
-	const int nrPixels{ m_Width * m_Height };
-	std::fill_n(m_pDepthBufferPixels, nrPixels, FLT_MAX);
-
-	//Loop over every mesh
-	for (Mesh& mesh : m_MeshesWorld)
+	//Clears background, only the part the render resolution uses
 	{
-		//Create vertices from indices
-		for (size_t i = 0; i < mesh.indices.size(); ++i)
+		PROFILE_ZONE("Software::Clear");
+		const int nrPixels{ m_Width * m_Height };
+		if (m_ClearColor)
 		{
-			m_VerticesWorld[i] = mesh.vertices[mesh.indices[i]];
+			std::fill_n(m_pBackBufferPixels, nrPixels, SDL_MapRGB(m_pBackBuffer->format, 26, 26, 26));
 		}
-
-		//Set maximum read count
-		m_VerticesCount = mesh.indices.size();
-
-		//VertexTransformationWorldToNDC();
-		VertexTransformationWorldToNDCNew(mesh);
-
-		for (size_t i = 0; i < m_VerticesCount; i++)
+		else
 		{
-			Vector2 temp;
-			temp.x = (mesh.vertices_out[i].position.x + 1) / 2 * static_cast<float>(m_Width);
-			temp.y = (1 - mesh.vertices_out[i].position.y) / 2 * static_cast<float>(m_Height);
-			m_VerticesScreenSpace[i] = temp;
+			std::fill_n(m_pBackBufferPixels, nrPixels, SDL_MapRGB(m_pBackBuffer->format, 100, 100, 100));
 		}
 
-		//RENDER LOGIC
-		switch (mesh.primitiveTopology)
+		if (m_IsMultisampled)
 		{
-		case PrimitiveTopology::TriangleList:
+			//Every pixel starts compressed, the clear color is the same for all its samples
+			std::fill_n(m_pSampleDepthBuffer, nrPixels * g_NrSamples, FLT_MAX);
+			std::fill_n(m_pPixelCompressed, nrPixels, uint8_t{ 1 });
+			std::fill_n(m_pTileDecompressed, m_NrMultisampleTilesX * ((m_Height + g_MultisampleTileSize - 1) / g_MultisampleTileSize), uint8_t{});
+		}
+		else
 		{
-			for (int i = 0; i < static_cast<int>(m_VerticesCount); i += 3)
-			{
-				DrawTriangle(i, false, mesh);
-			}
+			std::fill_n(m_pDepthBufferPixels, nrPixels, FLT_MAX);
 		}
-		break;
-		case PrimitiveTopology::TriangleStrip:
+	}
+
+	//Assign lights to clusters
+	{
+		PROFILE_ZONE("Software::LightGrid");
+		m_pLightGrid->Build(m_Lights, *m_pCamera);
+	}
+
+	//Opaque pass, the effect type picks the raster kernels at compile time
+	{
+		PROFILE_ZONE("Software::OpaquePass");
+		for (const SoftwareMesh* pMesh : m_pMeshes)
 		{
-			for (int i = 0; i < static_cast<int>(m_VerticesCount) - 2; ++i)
-			{
-				DrawTriangle(i, i % 2, mesh);
-			}
+			if (!pMesh->pGlobalMesh->isVisible || !m_pCamera->IsInFrustum(*pMesh->pGlobalMesh))
+				continue;
+
+			std::visit([this, pMesh](const auto& effect)
+				{
+					if constexpr (!std::decay_t<decltype(effect)>::IsTransparent)
+					{
+						RenderMesh(*pMesh, effect);
+					}
+				}, pMesh->effect);
 		}
-		break;
+	}
+
+	//Transparent pass, it doesn't write depth so there's nothing to visualize in the depth buffer
+	if (m_ShowFireMesh && !m_IsDepthBuffer)
+	{
+		PROFILE_ZONE("Software::TransparentPass");
+		for (const SoftwareMesh* pMesh : m_pMeshes)
+		{
+			if (!pMesh->pGlobalMesh->isVisible || !m_pCamera->IsInFrustum(*pMesh->pGlobalMesh))
+				continue;
+
+			std::visit([this, pMesh](const auto& effect)
+				{
+					if constexpr (std::decay_t<decltype(effect)>::IsTransparent)
+					{
+						RenderMesh(*pMesh, effect);
+					}
+				}, pMesh->effect);
 		}
 	}
 
+	//Resolve the samples into the back buffer before presenting
+	if (m_IsMultisampled && !m_IsBoundingBox)
+	{
+		PROFILE_ZONE("Software::Resolve");
+		ResolveMultisampling();
+	}
+
+	//Shading rates for the next frame come from the contrast of this one
+	if (m_IsVariableRateShading && !m_IsBoundingBox && !m_IsDepthBuffer)
+	{
+		PROFILE_ZONE("Software::ShadingRates");
+		UpdateShadingRates();
+	}
+
 	//Update SDL Surface
+	PROFILE_ZONE("Software::Present");
 	SDL_UnlockSurface(m_pBackBuffer);
-	SDL_BlitSurface(m_pBackBuffer, nullptr, m_pFrontBuffer, nullptr);
-	SDL_UpdateWindowSurface(m_pWindow);
-}
+	if (m_Width == m_MaxWidth && m_Height == m_MaxHeight)
+	{
+		SDL_BlitSurface(m_pBackBuffer, nullptr, m_pFrontBuffer, nullptr);
+	}
+	else
+	{
+		UpscaleToWindow();
+		SDL_BlitSurface(m_pUpscaleBuffer, nullptr, m_pFrontBuffer, nullptr);
+	}
+	if (!m_IsOffscreen)
+	{
+		SDL_UpdateWindowSurface(m_pWindow);
+	}
 
-size_t SoftwareRenderer::FindReserveSize() const
-{
-	size_t max{};
-	for (const Mesh& mesh : m_MeshesWorld)
+	if (m_CaptureInterval > 0 && m_FrameIndex % m_CaptureInterval == 0)
 	{
-		max = std::max(max, mesh.indices.size());
+		std::ostringstream path{};
+		path << m_CapturePathPrefix << std::setw(6) << std::setfill('0') << m_FrameIndex << m_CaptureExtension;
+		CapturePresentedFrame(path.str());
 	}
-	return max;
+	++m_FrameIndex;
 }
 
-void SoftwareRenderer::LoadMesh(const std::string& path)
+bool SoftwareRenderer::SaveBufferToImage() const
 {
-	//Create empty mesh
-	m_MeshesWorld.push_back(Mesh{ {},{}, PrimitiveTopology::TriangleList });
-
-	//Load mesh
-	Utils::SWParseOBJ(path, m_MeshesWorld[m_MeshesWorld.size() - 1].vertices, m_MeshesWorld[m_MeshesWorld.size() - 1].indices);
+	++m_NrScreenshots;
+	return CapturePresentedFrame("Screenshot_" + std::to_string(m_NrScreenshots) + ".png");
+}
 
-	//Set values for matrix
-	const Vector3 translation = { Vector3{ 0.0f, 0.f, 50.f } };
-	const Vector3 rotation = { 0.f, 0.f, 0.f };
-	const Vector3 scale = { 1.f, 1.f, 1.f };
+void SoftwareRenderer::SetCaptureInterval(int everyNthFrame, const std::string& pathPrefix, const std::string& extension)
+{
+	m_CaptureInterval = std::max(everyNthFrame, 0);
+	m_CapturePathPrefix = pathPrefix;
+	m_CaptureExtension = extension;
+	m_FrameIndex = 0;
+}
 
-	//Generate and apply matrix
-	for (const auto pgMesh : m_pGlobalMeshes)
+bool SoftwareRenderer::CapturePresentedFrame(std::string path) const
+{
+	//The render resolution is packed at the start of the back buffer, the upscale buffer uses its own pitch
+	if (m_Width == m_MaxWidth && m_Height == m_MaxHeight)
 	{
-		*pgMesh->pWorldMatrix = Matrix::CreateScale(scale) * Matrix::CreateRotation(rotation) * Matrix::CreateTranslation(translation);
+		return m_pFrameCapture->Submit(m_pBackBufferPixels, m_Width, m_Height, m_Width, m_pBackBuffer->format, std::move(path));
 	}
+	return m_pFrameCapture->Submit(static_cast<const uint32_t*>(m_pUpscaleBuffer->pixels), m_MaxWidth, m_MaxHeight, m_pUpscaleBuffer->pitch / static_cast<int>(sizeof(uint32_t)),
+		m_pUpscaleBuffer->format, std::move(path));
 }
 
-void SoftwareRenderer::VertexTransformationWorldToNDCNew(Mesh& mesh) const
+void SoftwareRenderer::ApplySettings(const SoftwareRenderSettings& settings)
 {
-	const Matrix matrix = *m_pGlobalMeshes[0]->pWorldMatrix * m_pCamera->viewMatrix * m_pCamera->projectionMatrix;
+	m_Rendermode = settings.renderMode;
+	m_IsNormal = settings.isNormal;
+	m_IsDepthBuffer = settings.isDepthBuffer;
+	m_IsBoundingBox = settings.isBoundingBox;
+	m_ClearColor = settings.isUniformClearColor;
+	m_ShowFireMesh = settings.showFireMesh;
+	m_IsRotating = settings.isRotating;
+	m_IsMultisampled = settings.isMultisampled;
+	m_IsMeshletCulling = settings.isMeshletCulling;
+
+	//Same resets as turning the toggles off by key
+	if (m_IsDynamicResolution && !settings.isDynamicResolution)
+	{
+		m_pDynamicResolution->Reset();
+		SetRenderResolution(m_MaxWidth, m_MaxHeight);
+	}
+	m_IsDynamicResolution = settings.isDynamicResolution;
 
-	Vertex_Out v{};
-	mesh.vertices_out.clear();
-	mesh.vertices_out.reserve(m_VerticesCount);
-	for (int i = 0; i < m_VerticesCount; i++)
+	if (m_IsVariableRateShading && !settings.isVariableRateShading)
 	{
-		v = { Vector4{}, m_VerticesWorld[i].color, m_VerticesWorld[i].uv, m_VerticesWorld[i].normal, m_VerticesWorld[i].tangent, m_VerticesWorld[i].viewDirection };
+		std::fill_n(m_pShadingRates, m_NrShadingRateTiles, g_ShadingRateFull);
+	}
+	m_IsVariableRateShading = settings.isVariableRateShading;
+}
 
-		//Apply tangent matrix
-		v.tangent = m_pGlobalMeshes[0]->pWorldMatrix->TransformVector(v.tangent).Normalized();
+void SoftwareRenderer::ToggleDynamicResolution()
+{
+	m_IsDynamicResolution = !m_IsDynamicResolution;
+	if (m_IsDynamicResolution)
+	{
+		std::cout << "ON (" << m_pDynamicResolution->GetTargetFrameTime() * 1000.f << " ms budget)";
+	}
+	else
+	{
+		std::cout << "OFF";
+		m_pDynamicResolution->Reset();
+		SetRenderResolution(m_MaxWidth, m_MaxHeight);
+	}
+}
+
+void SoftwareRenderer::ToggleVariableRateShading()
+{
+	m_IsVariableRateShading = !m_IsVariableRateShading;
+	if (m_IsVariableRateShading)
+	{
+		std::cout << "ON";
+	}
+	else
+	{
+		std::cout << "OFF";
+		std::fill_n(m_pShadingRates, m_NrShadingRateTiles, g_ShadingRateFull);
+	}
+}
 
-		//Apply normal matrix
-		v.normal = m_pGlobalMeshes[0]->pWorldMatrix->TransformVector(v.normal).Normalized();
+void SoftwareRenderer::UpdateShadingRates() const
+{
+	const SDL_PixelFormat* pFormat{ m_pBackBuffer->format };
+	const auto getLuminance = [pFormat](uint32_t pixel)
+	{
+		const uint32_t red{ (pixel >> pFormat->Rshift) & 0xFF };
+		const uint32_t green{ (pixel >> pFormat->Gshift) & 0xFF };
+		const uint32_t blue{ (pixel >> pFormat->Bshift) & 0xFF };
+		return static_cast<int>((red + 2 * green + blue) >> 2);
+	};
+
+	//Low contrast between the pixels a coarse block would merge means the merge isn't visible.
+	//Only an axis that was shaded at full rate this frame can be measured, a coarse one reads as flat whatever is in the tile.
+	const int nrTilesY{ (m_Height + g_ShadingRateTileSize - 1) / g_ShadingRateTileSize };
+	const int refreshPhase{ static_cast<int>(m_FrameIndex % g_ShadingRateRefreshInterval) };
+	for (int tileY{}; tileY < nrTilesY; ++tileY)
+	{
+		for (int tileX{}; tileX < m_NrShadingRateTilesX; ++tileX)
+		{
+			const int tileIndex{ tileY * m_NrShadingRateTilesX + tileX };
+			const uint8_t shadedRate{ m_pShadingRates[tileIndex] };
 
-		//Transfrom to camera matrix
-		v.position = matrix.TransformPoint({ m_VerticesWorld[i].position, 1 });
+			//Staggered over the tiles so the cost of the full rate frames is spread out
+			if (shadedRate != g_ShadingRateFull && (tileIndex + refreshPhase) % g_ShadingRateRefreshInterval == 0)
+			{
+				m_pShadingRates[tileIndex] = g_ShadingRateFull;
+				continue;
+			}
+			if (shadedRate == (g_ShadingRateCoarseX | g_ShadingRateCoarseY))
+				continue;
 
-		//Transform view direction
-		v.viewDirection = matrix.TransformPoint(v.viewDirection).Normalized();
+			const int minX{ tileX * g_ShadingRateTileSize };
+			const int minY{ tileY * g_ShadingRateTileSize };
+			const int maxX{ std::min(minX + g_ShadingRateTileSize, m_Width) };
+			const int maxY{ std::min(minY + g_ShadingRateTileSize, m_Height) };
 
-		//Perspective devide
-		v.position.x /= v.position.w;
-		v.position.y /= v.position.w;
-		v.position.z /= v.position.w;
+			int differenceX{}, nrPairsX{};
+			int differenceY{}, nrPairsY{};
+			for (int py{ minY }; py < maxY; ++py)
+			{
+				const uint32_t* pRow{ m_pBackBufferPixels + static_cast<ptrdiff_t>(py) * m_Width };
+				const uint32_t* pNextRow{ pRow + m_Width };
+				const bool hasNextRow{ (py & 1) == 0 && py + 1 < maxY };
+				for (int px{ minX }; px < maxX; ++px)
+				{
+					const int luminance{ getLuminance(pRow[px]) };
+					if ((px & 1) == 0 && px + 1 < maxX)
+					{
+						differenceX += std::abs(luminance - getLuminance(pRow[px + 1]));
+						++nrPairsX;
+					}
+					if (hasNextRow)
+					{
+						differenceY += std::abs(luminance - getLuminance(pNextRow[px]));
+						++nrPairsY;
+					}
+				}
+			}
 
-		mesh.vertices_out.emplace_back(v);
+			//A coarse axis keeps its rate until the tile is refreshed
+			uint8_t rate{ static_cast<uint8_t>(shadedRate & (g_ShadingRateCoarseX | g_ShadingRateCoarseY)) };
+			if (!(shadedRate & g_ShadingRateCoarseX) && nrPairsX > 0 && static_cast<float>(differenceX) < g_ShadingRateThreshold * static_cast<float>(nrPairsX))
+			{
+				rate |= g_ShadingRateCoarseX;
+			}
+			if (!(shadedRate & g_ShadingRateCoarseY) && nrPairsY > 0 && static_cast<float>(differenceY) < g_ShadingRateThreshold * static_cast<float>(nrPairsY))
+			{
+				rate |= g_ShadingRateCoarseY;
+			}
+			m_pShadingRates[tileIndex] = rate;
+		}
 	}
 }
 
-bool SoftwareRenderer::IsVerticesInFrustrum(const Vertex_Out& vertex)
+void SoftwareRenderer::SetRenderResolution(int width, int height)
 {
-	if (vertex.position.x < -1.f || vertex.position.x > 1.f)
+	m_Width = width;
+	m_Height = height;
+	m_NrMultisampleTilesX = (m_Width + g_MultisampleTileSize - 1) / g_MultisampleTileSize;
+	m_pLightGrid->Resize(m_Width, m_Height);
+
+	//The rates of the old resolution don't line up anymore, start from full rate
+	m_NrShadingRateTilesX = (m_Width + g_ShadingRateTileSize - 1) / g_ShadingRateTileSize;
+	m_NrShadingRateTiles = m_NrShadingRateTilesX * ((m_Height + g_ShadingRateTileSize - 1) / g_ShadingRateTileSize);
+	std::fill_n(m_pShadingRates, m_NrShadingRateTiles, g_ShadingRateFull);
+
+	//Horizontal bilinear taps only depend on the resolution, 8 bit fractional weights
+	const float scaleX{ static_cast<float>(m_Width) / static_cast<float>(m_MaxWidth) };
+	for (int x{}; x < m_MaxWidth; ++x)
 	{
-		return false;
+		const float sourceX{ std::max((static_cast<float>(x) + 0.5f) * scaleX - 0.5f, 0.f) };
+		UpscaleTap& tap{ m_UpscaleTaps[x] };
+		tap.x0 = std::min(static_cast<int>(sourceX), m_Width - 1);
+		tap.x1 = std::min(tap.x0 + 1, m_Width - 1);
+		tap.weight = static_cast<uint32_t>((sourceX - static_cast<float>(tap.x0)) * 256.f);
 	}
-	if (vertex.position.y < -1.f || vertex.position.y > 1.f)
+}
+
+void SoftwareRenderer::UpscaleToWindow() const
+{
+	//Lerp two pixels per channel, red/blue and green share one multiply each
+	const auto lerpPixel = [](uint32_t a, uint32_t b, uint32_t weight)
 	{
-		return false;
-	}
-	if (vertex.position.z < 0.f || vertex.position.z > 1.f)
+		const uint32_t invWeight{ 256 - weight };
+		const uint32_t redBlue{ (((a & 0xFF00FF) * invWeight + (b & 0xFF00FF) * weight) >> 8) & 0xFF00FF };
+		const uint32_t green{ (((a & 0x00FF00) * invWeight + (b & 0x00FF00) * weight) >> 8) & 0x00FF00 };
+		return redBlue | green;
+	};
+
+	SDL_LockSurface(m_pUpscaleBuffer);
+	const float scaleY{ static_cast<float>(m_Height) / static_cast<float>(m_MaxHeight) };
+	for (int y{}; y < m_MaxHeight; ++y)
 	{
-		return false;
+		const float sourceY{ std::max((static_cast<float>(y) + 0.5f) * scaleY - 0.5f, 0.f) };
+		const int y0{ std::min(static_cast<int>(sourceY), m_Height - 1) };
+		const int y1{ std::min(y0 + 1, m_Height - 1) };
+		const uint32_t weightY{ static_cast<uint32_t>((sourceY - static_cast<float>(y0)) * 256.f) };
+
+		const uint32_t* pRow0{ m_pBackBufferPixels + static_cast<ptrdiff_t>(y0) * m_Width };
+		const uint32_t* pRow1{ m_pBackBufferPixels + static_cast<ptrdiff_t>(y1) * m_Width };
+		uint32_t* pDestination{ reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(m_pUpscaleBuffer->pixels) + static_cast<ptrdiff_t>(y) * m_pUpscaleBuffer->pitch) };
+
+		for (int x{}; x < m_MaxWidth; ++x)
+		{
+			const UpscaleTap& tap{ m_UpscaleTaps[x] };
+			const uint32_t top{ lerpPixel(pRow0[tap.x0], pRow0[tap.x1], tap.weight) };
+			const uint32_t bottom{ lerpPixel(pRow1[tap.x0], pRow1[tap.x1], tap.weight) };
+			pDestination[x] = lerpPixel(top, bottom, weightY);
+		}
 	}
-	return true;
+	SDL_UnlockSurface(m_pUpscaleBuffer);
 }
 
-void SoftwareRenderer::PixelShading(const Vertex_Out& v) const
+template<typename Effect>
+void SoftwareRenderer::RenderMesh(const SoftwareMesh& softwareMesh, const Effect& effect)
 {
-	const int pixelIndex = static_cast<int>(v.position.x) + (static_cast<int>(v.position.y) * m_Width);
-	ColorRGB finalColor{ colors::White };
+	const Mesh& mesh{ softwareMesh.mesh };
 
-	if (m_IsDepthBuffer)
+	ShaderGlobals globals{};
+	globals.worldMatrix = *softwareMesh.pWorldMatrix;
+	globals.worldViewProjectionMatrix = softwareMesh.pGlobalMesh->GetWorldViewProjection(m_pCamera->viewProjectionMatrix, m_pCamera->viewProjectionVersion);
+	globals.cameraOrigin = m_pCamera->origin;
+	if (!m_pLightGrid->IsEmpty())
 	{
-		finalColor = { v.position.z,v.position.z ,v.position.z };
+		globals.pLightGrid = m_pLightGrid;
 	}
-	else
-	{
-		constexpr ColorRGB ambientColor{ 0.025f, 0.025f, 0.025f };
-		const Vector3 lightDirection = { 0.577f, -0.577f , 0.577f };
-		constexpr float lightIntensity = 7.f;
-		constexpr float shininess = 25.f;
-		constexpr float kd = 1.f;
-		Vector3 sampledNormal = v.normal;
 
-		if (m_IsNormal)
-		{
-			const Vector3 binormal = Vector3::Cross(v.normal, v.tangent);
-			const Matrix tangentSpaceAxis = { v.tangent, binormal, v.normal, Vector3::Zero };
+	//Cull whole meshlets before a single vertex is transformed
+	const bool isMeshletCulled{ m_IsMeshletCulling && !softwareMesh.meshlets.empty() && mesh.primitiveTopology == PrimitiveTopology::TriangleList };
+	if (isMeshletCulled)
+	{
+		PROFILE_ZONE("Software::MeshletCulling");
+		CullMeshlets(softwareMesh, Effect::IsTransparent ? None : *m_pCullMode);
+		if (m_VisibleMeshlets.empty())
+			return;
+	}
 
-			sampledNormal = m_pTextureNormal->SampleToVector(v.uv);
-			sampledNormal = 2.f * sampledNormal - Vector3::One;
-			sampledNormal = tangentSpaceAxis.TransformVector(sampledNormal);
+	const typename Effect::Varyings* pVaryings{ nullptr };
+	{
+		PROFILE_ZONE("Software::VertexTransform");
+		pVaryings = VertexTransformationWorldToScreen(softwareMesh, effect, globals, isMeshletCulled);
+	}
 
-			sampledNormal.Normalize();
-		}
+	//Raster and pixel stage are one inlined kernel, so shading is part of this zone
+	PROFILE_ZONE("Software::RasterAndShade");
 
-		const float observedArea = Vector3::DotClamp(sampledNormal, -lightDirection);
+	//Pick the raster kernel once, the toggles can't change during a frame
+	const DrawTriangleKernel<Effect> drawTriangle{ SelectDrawTriangleKernel<Effect>() };
 
-		switch (m_Rendermode)
-		{
-		case ObservedArea:
-			finalColor = colors::White * observedArea;
-			break;
-		case Diffuse:
-			finalColor = (m_pTexture->Sample(v.uv) * kd / PI) * lightIntensity * observedArea;
-			break;
-		case Specular:
+	//First index of every triangle list triangle that can still be visible
+	const auto forEachTriangle = [&](auto&& function)
+	{
+		if (isMeshletCulled)
 		{
-			ColorRGB specularColor{ colors::Blue };
-			CalculateSpecular(sampledNormal, lightDirection, v, shininess, specularColor);
-			finalColor = specularColor * observedArea;
+			for (const uint32_t meshletIndex : m_VisibleMeshlets)
+			{
+				const Meshlet& meshlet{ softwareMesh.meshlets[meshletIndex] };
+				const size_t end{ (static_cast<size_t>(meshlet.triangleOffset) + meshlet.triangleCount) * 3 };
+				for (size_t i{ static_cast<size_t>(meshlet.triangleOffset) * 3 }; i < end; i += 3)
+				{
+					function(i);
+				}
+			}
+			return;
 		}
-		break;
-		case Combined:
+
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
 		{
-			ColorRGB specularColor{};
-			CalculateSpecular(sampledNormal, lightDirection, v, shininess, specularColor);
+			function(i);
+		}
+	};
 
-			finalColor = (m_pTexture->Sample(v.uv) * kd / PI) * lightIntensity * observedArea + specularColor;
+	//Blending needs the triangles back to front, sort them on their summed view depth
+	if constexpr (Effect::IsTransparent)
+	{
+		m_SortedTriangles.clear();
+		forEachTriangle([&](size_t i)
+			{
+				const float depth{ m_VerticesProjected[mesh.indices[i]].w + m_VerticesProjected[mesh.indices[i + 1]].w + m_VerticesProjected[mesh.indices[i + 2]].w };
+				m_SortedTriangles.emplace_back(depth, static_cast<uint32_t>(i));
+			});
+		std::sort(m_SortedTriangles.begin(), m_SortedTriangles.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+		for (const auto& [depth, i] : m_SortedTriangles)
+		{
+			(this->*drawTriangle)(effect, globals, pVaryings, mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]);
 		}
-		break;
+		return;
+	}
+
+	//RENDER LOGIC
+	switch (mesh.primitiveTopology)
+	{
+	case PrimitiveTopology::TriangleList:
+	{
+		forEachTriangle([&](size_t i)
+			{
+				(this->*drawTriangle)(effect, globals, pVaryings, mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2]);
+			});
+	}
+	break;
+	case PrimitiveTopology::TriangleStrip:
+	{
+		for (size_t i = 0; i + 2 < mesh.indices.size(); ++i)
+		{
+			const size_t swapVertices{ i % 2 };
+			(this->*drawTriangle)(effect, globals, pVaryings, mesh.indices[i], mesh.indices[i + 1 + swapVertices], mesh.indices[i + 2 - swapVertices]);
 		}
+	}
+	break;
+	}
+}
+
+size_t SoftwareRenderer::FindReserveSize() const
+{
+	size_t max{};
+	for (const SoftwareMesh* pMesh : m_pMeshes)
+	{
+		max = std::max(max, pMesh->GetNrVertices());
+	}
+	return max;
+}
+
+void SoftwareRenderer::LoadMesh(const std::string& path, GlobalMesh* pGlobalMesh, const SoftwareEffectVariant& effect)
+{
+	//Create empty mesh
+	const auto pMesh = new SoftwareMesh{ Mesh{ {},{}, PrimitiveTopology::TriangleList }, effect, pGlobalMesh->pWorldMatrix, pGlobalMesh };
 
-		finalColor += ambientColor;
+	//Transparent meshes are blended in triangle order, the importer may not reorder them
+	const bool isTransparent{ std::visit([](const auto& e) { return std::decay_t<decltype(e)>::IsTransparent; }, effect) };
+	MeshImportOptions options{};
+	options.keepTriangleOrder = isTransparent;
+	if (const std::shared_ptr<const MeshData> pMeshData{ m_pAssetCache->LoadMesh(path, options) })
+	{
+		//Bounds and occluder are shared with the hardware renderer, transparent meshes don't hide anything
+		InitializeGlobalMesh(*pGlobalMesh, *pMeshData, !isTransparent);
+		Utils::SWConvertMesh(*pMeshData, pMesh->mesh.vertices, pMesh->mesh.indices);
 	}
 
+	BuildMeshlets(pMesh->mesh, pMesh->meshlets, pMesh->meshletVertices);
+
+	//Everything that needs full precision is built, keep only the compact vertices
+	if constexpr (g_UseQuantizedVertices)
+	{
+		pMesh->quantizationBounds = Quantization::CalculateBounds(pGlobalMesh->boundsMin, pGlobalMesh->boundsMax);
+		pMesh->quantizedVertices.reserve(pMesh->mesh.vertices.size());
+		for (const Vertex_In& vertex : pMesh->mesh.vertices)
+		{
+			pMesh->quantizedVertices.push_back(Quantization::Encode(vertex.position, vertex.normal, vertex.tangent, vertex.uv, pMesh->quantizationBounds));
+		}
+		pMesh->mesh.vertices.clear();
+		pMesh->mesh.vertices.shrink_to_fit();
+	}
 
-	finalColor.MaxToOne();
-	m_pBackBufferPixels[pixelIndex] = SDL_MapRGB(m_pBackBuffer->format,
-		static_cast<uint8_t>(finalColor.r * 255),
-		static_cast<uint8_t>(finalColor.g * 255),
-		static_cast<uint8_t>(finalColor.b * 255));
+	pGlobalMesh->pSMesh = pMesh;
+	m_pMeshes.push_back(pMesh);
 }
 
-void SoftwareRenderer::CalculateSpecular(const Vector3& sampledNormal, const Vector3& lightDirection, const Vertex_Out& v, const float shininess, ColorRGB& output) const
+void SoftwareRenderer::CullMeshlets(const SoftwareMesh& softwareMesh, CullMode cullMode)
 {
-	const Vector3 reflectDirection{ Vector3::Reflect(lightDirection, sampledNormal) };
+	const Matrix& worldMatrix{ *softwareMesh.pWorldMatrix };
+	const float maxScale{ sqrtf(std::max({ worldMatrix.GetAxisX().SqrMagnitude(), worldMatrix.GetAxisY().SqrMagnitude(), worldMatrix.GetAxisZ().SqrMagnitude() })) };
 
-	const float cosAngle = Vector3::DotClamp(reflectDirection, -v.viewDirection);
+	m_VisibleMeshlets.clear();
+	for (uint32_t i{}; i < softwareMesh.meshlets.size(); ++i)
+	{
+		const Meshlet& meshlet{ softwareMesh.meshlets[i] };
+		const Vector3 center{ worldMatrix.TransformPoint(meshlet.center) };
+		const float radius{ meshlet.radius * maxScale };
 
-	const float glossExponent{ m_pTextureGloss->Sample(v.uv).r * shininess };
+		if (!m_pCamera->IsSphereInFrustum(center, radius))
+			continue;
 
-	const float phong{ powf(cosAngle, glossExponent) };
+		//Every triangle faces away from the camera (or towards it when front faces are culled)
+		if (cullMode != None && meshlet.coneCutoff <= 1.f)
+		{
+			Vector3 axis{ worldMatrix.TransformVector(meshlet.coneAxis).Normalized() };
+			if (cullMode == Front)
+			{
+				axis = -axis;
+			}
 
-	output = m_pTextureSpecular->Sample(v.uv) * phong;
+			const Vector3 cameraToCenter{ center - m_pCamera->origin };
+			if (Vector3::Dot(cameraToCenter, axis) >= meshlet.coneCutoff * cameraToCenter.Magnitude() + radius)
+				continue;
+		}
+
+		m_VisibleMeshlets.push_back(i);
+	}
 }
 
-void SoftwareRenderer::DrawTriangle(int i, bool swapVertices, const Mesh& mesh) const
+template<typename Effect>
+const typename Effect::Varyings* SoftwareRenderer::VertexTransformationWorldToScreen(const SoftwareMesh& softwareMesh, const Effect& effect, const ShaderGlobals& globals, bool isMeshletCulled)
 {
-	//Predefine indexes
-	const uint32_t vertexIndex0 = i;
-	const uint32_t vertexIndex1 = i + 1 * !swapVertices + 2 * swapVertices;
-	const uint32_t vertexIndex2 = i + 2 * !swapVertices + 1 * swapVertices;
+	const Mesh& mesh{ softwareMesh.mesh };
+
+	using Varyings = typename Effect::Varyings;
+	static_assert(alignof(Varyings) <= alignof(float));
+	constexpr size_t nrFloats{ sizeof(Varyings) / sizeof(float) };
+
+	const size_t nrVertices{ softwareMesh.GetNrVertices() };
+	if (m_VerticesProjected.size() < nrVertices)
+	{
+		m_VerticesProjected.resize(nrVertices);
+	}
+	if (m_VerticesVaryings.size() < nrVertices * nrFloats)
+	{
+		m_VerticesVaryings.resize(nrVertices * nrFloats);
+	}
+
+	Varyings* pVaryings{ reinterpret_cast<Varyings*>(m_VerticesVaryings.data()) };
+
+	//Vertex stage per vertex, the positions are gathered into SoA and go to clip space together
+	const auto transformBatch = [&](const uint32_t* pIndices, size_t count)
+	{
+		alignas(16) std::array<float, g_TransformBatchSize> positionsX;
+		alignas(16) std::array<float, g_TransformBatchSize> positionsY;
+		alignas(16) std::array<float, g_TransformBatchSize> positionsZ;
+		std::array<Vector4, g_TransformBatchSize> positions;
+
+		for (size_t j{}; j < count; ++j)
+		{
+			const uint32_t i{ pIndices[j] };
+			const Vertex_In* pVertex{ nullptr };
+			Vertex_In decoded;
+			if (softwareMesh.IsQuantized())
+			{
+				Quantization::Decode(softwareMesh.quantizedVertices[i], softwareMesh.quantizationBounds, decoded);
+				pVertex = &decoded;
+			}
+			else
+			{
+				pVertex = &mesh.vertices[i];
+			}
+
+			effect.vertexStage(*pVertex, globals, pVaryings[i]);
+			positionsX[j] = pVertex->position.x;
+			positionsY[j] = pVertex->position.y;
+			positionsZ[j] = pVertex->position.z;
+		}
+
+		globals.worldViewProjectionMatrix.TransformPoints(positionsX.data(), positionsY.data(), positionsZ.data(), count, positions.data());
+
+		for (size_t j{}; j < count; ++j)
+		{
+			Vector4& position{ positions[j] };
+
+			//Perspective devide
+			position.x /= position.w;
+			position.y /= position.w;
+			position.z /= position.w;
+
+			//To screen space
+			position.x = (position.x + 1) / 2 * static_cast<float>(m_Width);
+			position.y = (1 - position.y) / 2 * static_cast<float>(m_Height);
+
+			m_VerticesProjected[pIndices[j]] = position;
+		}
+	};
+
+	if (!isMeshletCulled)
+	{
+		std::array<uint32_t, g_TransformBatchSize> indices;
+		for (size_t first{}; first < nrVertices; first += g_TransformBatchSize)
+		{
+			const size_t count{ std::min(g_TransformBatchSize, nrVertices - first) };
+			std::iota(indices.begin(), indices.begin() + count, static_cast<uint32_t>(first));
+			transformBatch(indices.data(), count);
+		}
+		return pVaryings;
+	}
+
+	//Only the vertices of visible meshlets, the stamp skips vertices on the border of two meshlets
+	if (m_VertexStamps.size() < nrVertices)
+	{
+		m_VertexStamps.resize(nrVertices);
+	}
+	++m_VertexStamp;
+	static_assert(Meshlet::MaxVertices <= g_TransformBatchSize, "A meshlet has to fit in one transform batch");
+	std::array<uint32_t, g_TransformBatchSize> indices;
+	for (const uint32_t meshletIndex : m_VisibleMeshlets)
+	{
+		const Meshlet& meshlet{ softwareMesh.meshlets[meshletIndex] };
+		size_t count{};
+		for (uint32_t i{}; i < meshlet.vertexCount; ++i)
+		{
+			const uint32_t vertexIndex{ softwareMesh.meshletVertices[meshlet.vertexOffset + i] };
+			if (m_VertexStamps[vertexIndex] != m_VertexStamp)
+			{
+				m_VertexStamps[vertexIndex] = m_VertexStamp;
+				indices[count++] = vertexIndex;
+			}
+		}
+		transformBatch(indices.data(), count);
+	}
+	return pVaryings;
+}
+
+bool SoftwareRenderer::IsVerticesInFrustrum(const Vector4& vertex) const
+{
+	if (vertex.x < 0.f || vertex.x > static_cast<float>(m_Width))
+	{
+		return false;
+	}
+	if (vertex.y < 0.f || vertex.y > static_cast<float>(m_Height))
+	{
+		return false;
+	}
+	if (vertex.z < 0.f || vertex.z > 1.f)
+	{
+		return false;
+	}
+	return true;
+}
+
+template<typename Effect, bool isMultisampled, bool isBoundingBox, CullMode cullMode, bool isDepthBuffer, bool isNormal, RenderMode renderMode>
+void SoftwareRenderer::DrawTriangle(const Effect& effect, const ShaderGlobals& globals, const typename Effect::Varyings* pVaryings, uint32_t vertexIndex0, uint32_t vertexIndex1, uint32_t vertexIndex2) const
+{
+	const Vector4& vertex0{ m_VerticesProjected[vertexIndex0] };
+	const Vector4& vertex1{ m_VerticesProjected[vertexIndex1] };
+	const Vector4& vertex2{ m_VerticesProjected[vertexIndex2] };
+
+	const Vector2 screenV0{ vertex0.GetXY() };
+	const Vector2 screenV1{ vertex1.GetXY() };
+	const Vector2 screenV2{ vertex2.GetXY() };
 
 	//Calculate edges
-	const Vector2 edgeV0V1 = m_VerticesScreenSpace[vertexIndex1] - m_VerticesScreenSpace[vertexIndex0];
-	const Vector2 edgeV1V2 = m_VerticesScreenSpace[vertexIndex2] - m_VerticesScreenSpace[vertexIndex1];
-	const Vector2 edgeV2V0 = m_VerticesScreenSpace[vertexIndex0] - m_VerticesScreenSpace[vertexIndex2];
+	const Vector2 edgeV0V1 = screenV1 - screenV0;
+	const Vector2 edgeV1V2 = screenV2 - screenV1;
+	const Vector2 edgeV2V0 = screenV0 - screenV2;
 
 	//Check if triangle is valid
 	if (edgeV0V1.SqrMagnitude() < FLT_EPSILON || edgeV1V2.SqrMagnitude() < FLT_EPSILON || edgeV2V0.SqrMagnitude() < FLT_EPSILON)
@@ -303,69 +838,278 @@ void SoftwareRenderer::DrawTriangle(int i, bool swapVertices, const Mesh& mesh)
 		return;
 	}
 
-	if (IsVerticesInFrustrum(mesh.vertices_out[vertexIndex0]) == false) { return; }
-	if (IsVerticesInFrustrum(mesh.vertices_out[vertexIndex1]) == false) { return; }
-	if (IsVerticesInFrustrum(mesh.vertices_out[vertexIndex2]) == false) { return; }
+	if (IsVerticesInFrustrum(vertex0) == false) { return; }
+	if (IsVerticesInFrustrum(vertex1) == false) { return; }
+	if (IsVerticesInFrustrum(vertex2) == false) { return; }
 
 	const float fullTriangleArea = Vector2::Cross(edgeV0V1, edgeV1V2);
 
 	//Create bounding box for optimized rendering
-	Vector2 minBoundingBox{ Vector2::Min(m_VerticesScreenSpace[vertexIndex0], Vector2::Min(m_VerticesScreenSpace[vertexIndex1], m_VerticesScreenSpace[vertexIndex2])) };
-	Vector2 maxBoundingBox{ Vector2::Max(m_VerticesScreenSpace[vertexIndex0], Vector2::Max(m_VerticesScreenSpace[vertexIndex1], m_VerticesScreenSpace[vertexIndex2])) };
+	Vector2 minBoundingBox{ Vector2::Min(screenV0, Vector2::Min(screenV1, screenV2)) };
+	Vector2 maxBoundingBox{ Vector2::Max(screenV0, Vector2::Max(screenV1, screenV2)) };
 	minBoundingBox.Clamp(static_cast<float>(m_Width), static_cast<float>(m_Height));
 	maxBoundingBox.Clamp(static_cast<float>(m_Width), static_cast<float>(m_Height));
 	constexpr int offset = 1;
-	const int maxX = static_cast<int>(maxBoundingBox.x) + offset;
-	const int maxY = static_cast<int>(maxBoundingBox.y) + offset;
+	const int maxX = std::min(static_cast<int>(maxBoundingBox.x) + offset, m_Width);
+	const int maxY = std::min(static_cast<int>(maxBoundingBox.y) + offset, m_Height);
+
+	//Invert depths once per triangle
+	const float invDepthV0{ 1.f / vertex0.z };
+	const float invDepthV1{ 1.f / vertex1.z };
+	const float invDepthV2{ 1.f / vertex2.z };
+	const float invInterpolatedDepthV0{ 1.f / vertex0.w };
+	const float invInterpolatedDepthV1{ 1.f / vertex1.w };
+	const float invInterpolatedDepthV2{ 1.f / vertex2.w };
+
+	//Barycentric weight of an edge function, the fast policy trades the divide for one reciprocal per triangle
+	const float invTriangleArea{ ShadingPrecision::Reciprocal(fullTriangleArea) };
+	const auto getWeight = [fullTriangleArea, invTriangleArea](float edge) MATH_INLINE_LAMBDA
+	{
+		if constexpr (ShadingPrecision::IsExact)
+		{
+			return edge / fullTriangleArea;
+		}
+		else
+		{
+			return edge * invTriangleArea;
+		}
+	};
+
+	//Edge test with the cull mode baked in
+	const auto isCovered = [](float edge0, float edge1, float edge2) MATH_INLINE_LAMBDA
+	{
+		const bool isFront{ edge0 >= 0 && edge1 >= 0 && edge2 >= 0 };
+		const bool isBack{ edge0 <= 0 && edge1 <= 0 && edge2 <= 0 };
+		if constexpr (cullMode == Back)
+		{
+			return isFront;
+		}
+		else if constexpr (cullMode == Front)
+		{
+			return isBack;
+		}
+		else
+		{
+			return isFront || isBack;
+		}
+	};
 
-	//Loop over every pixel that matches the bounding box
-	for (int px{ static_cast<int>(minBoundingBox.x) }; px < maxX; ++px)
+	//Depth visualization or the pixel stage of the effect, runs once per pixel
+	const auto shadePixel = [&](int px, int py, float weightV0, float weightV1, float weightV2, float interpolatedDepth) MATH_INLINE_LAMBDA
 	{
-		for (int py{ static_cast<int>(minBoundingBox.y) }; py < maxY; ++py)
+		ColorRGB finalColor{};
+		if constexpr (isDepthBuffer)
+		{
+			//Set depth for color
+			const float depthColor{ Remap(interpolatedDepth, .997f, 1.f) };
+			finalColor = { depthColor, depthColor, depthColor };
+		}
+		else
+		{
+			//Calculate depth
+			const float interpolatedPixelDepth
+			{
+				ShadingPrecision::Reciprocal
+				(
+					weightV0 * invInterpolatedDepthV0 +
+					weightV1 * invInterpolatedDepthV1 +
+					weightV2 * invInterpolatedDepthV2
+				)
+			};
+
+			//Interpolate every attribute of the effect
+			const typename Effect::Varyings pixelInfo{ InterpolateVaryings(
+				pVaryings[vertexIndex0], pVaryings[vertexIndex1], pVaryings[vertexIndex2],
+				weightV0 * invInterpolatedDepthV0 * interpolatedPixelDepth,
+				weightV1 * invInterpolatedDepthV1 * interpolatedPixelDepth,
+				weightV2 * invInterpolatedDepthV2 * interpolatedPixelDepth) };
+
+			//Pixel stage
+			const Fragment fragment{ px, py, interpolatedPixelDepth };
+			finalColor = effect.pixelStage(pixelInfo, globals, fragment, ShadingKernel<isNormal, renderMode>{});
+		}
+
+		finalColor.MaxToOne();
+		return finalColor;
+	};
+
+	const auto toPixelColor = [this](const ColorRGB& color) MATH_INLINE_LAMBDA
+	{
+		return m_BackBufferFormat.MapRGB(
+			static_cast<uint8_t>(color.r * 255),
+			static_cast<uint8_t>(color.g * 255),
+			static_cast<uint8_t>(color.b * 255));
+	};
+
+	//Variable rate shading: the pixels of one coarse block reuse the color of the first pixel that got shaded in it.
+	//Coverage and depth stay per pixel, the cache is one entry per column and tagged with the triangle and block row.
+	const uint32_t triangleStamp{ ++m_CoarseShadeStamp };
+	const auto shadeCoarsePixel = [&](int px, int py, float weightV0, float weightV1, float weightV2, float interpolatedDepth) MATH_INLINE_LAMBDA
+	{
+		if constexpr (!isDepthBuffer)
+		{
+			const uint8_t rate{ m_pShadingRates[(py / g_ShadingRateTileSize) * m_NrShadingRateTilesX + px / g_ShadingRateTileSize] };
+			if (rate != g_ShadingRateFull)
+			{
+				const int blockX{ (rate & g_ShadingRateCoarseX) ? px & ~1 : px };
+				const int blockY{ (rate & g_ShadingRateCoarseY) ? py & ~1 : py };
+				CoarseShade& coarseShade{ m_pCoarseShades[blockX] };
+				if (coarseShade.triangle != triangleStamp || coarseShade.blockY != blockY)
+				{
+					coarseShade = { triangleStamp, blockY, shadePixel(px, py, weightV0, weightV1, weightV2, interpolatedDepth) };
+				}
+				return coarseShade.color;
+			}
+		}
+		return shadePixel(px, py, weightV0, weightV1, weightV2, interpolatedDepth);
+	};
+
+	//Loop over every pixel that matches the bounding box, row by row
+	const int minX = static_cast<int>(minBoundingBox.x);
+	for (int py{ static_cast<int>(minBoundingBox.y) }; py < maxY; ++py)
+	{
+		for (int px{ minX }; px < maxX; ++px)
 		{
 			const int index = px + py * m_Width;
 
-			if (m_IsBoundingBox)
+			if constexpr (isBoundingBox)
 			{
-				m_pBackBufferPixels[index] = SDL_MapRGB(m_pBackBuffer->format,
+				m_pBackBufferPixels[index] = m_BackBufferFormat.MapRGB(
 					static_cast<uint8_t>(255),
 					static_cast<uint8_t>(255),
 					static_cast<uint8_t>(255));
 				continue;
 			}
 
+			if constexpr (isMultisampled)
+			{
+				//Coverage and depth per sample
+				uint32_t coverageMask{};
+				float sampleDepths[g_NrSamples]{};
+				float shadeWeights[3]{};
+				float shadeDepth{};
+
+				for (int sample{}; sample < g_NrSamples; ++sample)
+				{
+					const Vector2 samplePoint{ static_cast<float>(px) + g_SampleOffsets[sample][0], static_cast<float>(py) + g_SampleOffsets[sample][1] };
+					const float edge0 = Vector2::Cross(edgeV0V1, samplePoint - screenV0);
+					const float edge1 = Vector2::Cross(edgeV1V2, samplePoint - screenV1);
+					const float edge2 = Vector2::Cross(edgeV2V0, samplePoint - screenV2);
+					if (!isCovered(edge0, edge1, edge2))
+					{
+						continue;
+					}
+
+					const float weightV0 = getWeight(edge1);
+					const float weightV1 = getWeight(edge2);
+					const float weightV2 = getWeight(edge0);
+					const float interpolatedDepth{ 1.0f / (weightV0 * invDepthV0 + weightV1 * invDepthV1 + weightV2 * invDepthV2) };
+
+					if (m_pSampleDepthBuffer[index * g_NrSamples + sample] < interpolatedDepth)
+					{
+						continue;
+					}
+
+					//Shade at the first sample that survives, it is always inside the triangle
+					if (coverageMask == 0)
+					{
+						shadeWeights[0] = weightV0;
+						shadeWeights[1] = weightV1;
+						shadeWeights[2] = weightV2;
+						shadeDepth = interpolatedDepth;
+					}
+					coverageMask |= 1u << sample;
+					sampleDepths[sample] = interpolatedDepth;
+				}
+
+				if (coverageMask == 0)
+				{
+					continue;
+				}
+
+				//Transparent geometry is depth tested but doesn't write depth
+				if constexpr (!Effect::IsTransparent)
+				{
+					for (int sample{}; sample < g_NrSamples; ++sample)
+					{
+						if (coverageMask & (1u << sample))
+						{
+							m_pSampleDepthBuffer[index * g_NrSamples + sample] = sampleDepths[sample];
+						}
+					}
+				}
+
+				const ColorRGB finalColor{ shadeCoarsePixel(px, py, shadeWeights[0], shadeWeights[1], shadeWeights[2], shadeDepth) };
+				const uint32_t pixelColor{ toPixelColor(finalColor) };
+				const bool isFullyCovered{ coverageMask == g_FullCoverageMask };
+
+				if constexpr (Effect::IsTransparent)
+				{
+					const uint8_t alpha{ static_cast<uint8_t>(Saturate(finalColor.a) * 255) };
+					if (isFullyCovered && m_pPixelCompressed[index])
+					{
+						m_pBlendSpanColors[px - minX] = pixelColor;
+						m_pBlendSpanAlpha[px - minX] = alpha;
+						continue;
+					}
+
+					DecompressPixel(px, py);
+					for (int sample{}; sample < g_NrSamples; ++sample)
+					{
+						if (coverageMask & (1u << sample))
+						{
+							uint32_t& sampleColor{ m_pSampleColorBuffer[index * g_NrSamples + sample] };
+							sampleColor = Blend::BlendPixel(pixelColor, sampleColor, alpha);
+						}
+					}
+				}
+				else
+				{
+					//A fully covered pixel holds one color, only edges need every sample
+					if (isFullyCovered)
+					{
+						m_pPixelCompressed[index] = 1;
+						m_pBackBufferPixels[index] = pixelColor;
+						continue;
+					}
+
+					DecompressPixel(px, py);
+					for (int sample{}; sample < g_NrSamples; ++sample)
+					{
+						if (coverageMask & (1u << sample))
+						{
+							m_pSampleColorBuffer[index * g_NrSamples + sample] = pixelColor;
+						}
+					}
+				}
+				continue;
+			}
+
 			const Vector2 pointToSide = Vector2{ static_cast<float>(px), static_cast<float>(py) };
-			const Vector2 pointV0 = pointToSide - m_VerticesScreenSpace[vertexIndex0];
-			const Vector2 pointV1 = pointToSide - m_VerticesScreenSpace[vertexIndex1];
-			const Vector2 pointV2 = pointToSide - m_VerticesScreenSpace[vertexIndex2];
+			const Vector2 pointV0 = pointToSide - screenV0;
+			const Vector2 pointV1 = pointToSide - screenV1;
+			const Vector2 pointV2 = pointToSide - screenV2;
 			const float edge0 = Vector2::Cross(edgeV0V1, pointV0);
 			const float edge1 = Vector2::Cross(edgeV1V2, pointV1);
 			const float edge2 = Vector2::Cross(edgeV2V0, pointV2);
 
 			//Culling
-			const bool isFront{ edge0 >= 0 && edge1 >= 0 && edge2 >= 0 };
-			const bool isBack{ edge0 <= 0 && edge1 <= 0 && edge2 <= 0 };
-			if ((*m_pCullMode == Back && !isFront) || (*m_pCullMode == Front && !isBack) || (*m_pCullMode == None && !isBack && !isFront))
+			if (!isCovered(edge0, edge1, edge2))
 			{
 				continue;
 			}
 
-
 			//Calculate the barycentric weight
-			const float weightV0 = edge1 / fullTriangleArea;
-			const float weightV1 = edge2 / fullTriangleArea;
-			const float weightV2 = edge0 / fullTriangleArea;
-
-			const float depthV0 = mesh.vertices_out[vertexIndex0].position.z;
-			const float depthV1 = mesh.vertices_out[vertexIndex1].position.z;
-			const float depthV2 = mesh.vertices_out[vertexIndex2].position.z;
+			const float weightV0 = getWeight(edge1);
+			const float weightV1 = getWeight(edge2);
+			const float weightV2 = getWeight(edge0);
 
 			const float interpolatedDepth
 			{
 				1.0f /
-				(weightV0 / depthV0 +
-				weightV1 / depthV1 +
-				weightV2 / depthV2)
+				(weightV0 * invDepthV0 +
+				weightV1 * invDepthV1 +
+				weightV2 * invDepthV2)
 			};
 
 			if (m_pDepthBufferPixels[index] < interpolatedDepth)
@@ -373,72 +1117,184 @@ void SoftwareRenderer::DrawTriangle(int i, bool swapVertices, const Mesh& mesh)
 				continue;
 			}
 
-			m_pDepthBufferPixels[index] = interpolatedDepth;
+			//Transparent geometry is depth tested but doesn't write depth
+			if constexpr (!Effect::IsTransparent)
+			{
+				m_pDepthBufferPixels[index] = interpolatedDepth;
+			}
 
-			//Set basic info
-			Vertex_Out pixelInfo{};
-			pixelInfo.position.x = static_cast<float>(px);
-			pixelInfo.position.y = static_cast<float>(py);
-			pixelInfo.color = colors::White;
+			const ColorRGB finalColor{ shadeCoarsePixel(px, py, weightV0, weightV1, weightV2, interpolatedDepth) };
+			const uint32_t pixelColor{ toPixelColor(finalColor) };
 
-			if (m_IsDepthBuffer)
+			if constexpr (Effect::IsTransparent)
 			{
-				//Set depth for color
-				pixelInfo.position.z = Remap(interpolatedDepth, .997f, 1.f);
+				//Collect the row, it gets blended in one go
+				m_pBlendSpanColors[px - minX] = pixelColor;
+				m_pBlendSpanAlpha[px - minX] = static_cast<uint8_t>(Saturate(finalColor.a) * 255);
 			}
 			else
 			{
-				//Calculate depth
-				const float invInterpolatedDepthV0{ 1.f / mesh.vertices_out[vertexIndex0].position.w };
-				const float invInterpolatedDepthV1{ 1.f / mesh.vertices_out[vertexIndex1].position.w };
-				const float invInterpolatedDepthV2{ 1.f / mesh.vertices_out[vertexIndex2].position.w };
+				m_pBackBufferPixels[index] = pixelColor;
+			}
+		}
 
-				const float interpolatedPixelDepth
-				{
-					1.f /
-					(
-						weightV0 * invInterpolatedDepthV0 +
-						weightV1 * invInterpolatedDepthV1 +
-						weightV2 * invInterpolatedDepthV2
-					)
-				};
-				pixelInfo.position.w = interpolatedDepth;
-
-				//Calculate uv
-				const Vector2 pixelUV
-				{
-					(weightV0 * mesh.vertices_out[vertexIndex0].uv * invInterpolatedDepthV0 +
-					weightV1 * mesh.vertices_out[vertexIndex1].uv * invInterpolatedDepthV1 +
-					weightV2 * mesh.vertices_out[vertexIndex2].uv * invInterpolatedDepthV2)
-						* interpolatedPixelDepth
-				};
-				pixelInfo.uv = pixelUV;
-
-				//Calculate normal
-				pixelInfo.normal =
-				{
-					((((mesh.vertices_out[vertexIndex0].normal / mesh.vertices_out[vertexIndex0].position.w) * weightV0) +
-					((mesh.vertices_out[vertexIndex1].normal / mesh.vertices_out[vertexIndex1].position.w) * weightV1) +
-					((mesh.vertices_out[vertexIndex2].normal / mesh.vertices_out[vertexIndex2].position.w) * weightV2)) * interpolatedPixelDepth).Normalized()
-				};
+		if constexpr (Effect::IsTransparent)
+		{
+			Blend::BlendSpan(m_pBackBufferPixels + static_cast<ptrdiff_t>(py) * m_Width + minX, m_pBlendSpanColors, m_pBlendSpanAlpha, maxX - minX);
+		}
+	}
+}
 
-				//Calculate tangent
-				pixelInfo.tangent =
-				{
-					((((mesh.vertices_out[vertexIndex0].tangent / mesh.vertices_out[vertexIndex0].position.w) * weightV0) +
-					((mesh.vertices_out[vertexIndex1].tangent / mesh.vertices_out[vertexIndex1].position.w) * weightV1) +
-					((mesh.vertices_out[vertexIndex2].tangent / mesh.vertices_out[vertexIndex2].position.w) * weightV2)) * interpolatedPixelDepth).Normalized()
-				};
+void SoftwareRenderer::DecompressPixel(int px, int py) const
+{
+	const int index{ px + py * m_Width };
+	if (!m_pPixelCompressed[index])
+	{
+		return;
+	}
+
+	std::fill_n(m_pSampleColorBuffer + static_cast<ptrdiff_t>(index) * g_NrSamples, g_NrSamples, m_pBackBufferPixels[index]);
+	m_pPixelCompressed[index] = 0;
+	m_pTileDecompressed[(py / g_MultisampleTileSize) * m_NrMultisampleTilesX + px / g_MultisampleTileSize] = 1;
+}
 
-				//Calculate viewDirection
-				pixelInfo.viewDirection =
+void SoftwareRenderer::ResolveMultisampling() const
+{
+	//Only tiles that hold an edge have decompressed pixels, the rest already sit in the back buffer
+	const int nrTilesY{ (m_Height + g_MultisampleTileSize - 1) / g_MultisampleTileSize };
+	for (int tileY{}; tileY < nrTilesY; ++tileY)
+	{
+		for (int tileX{}; tileX < m_NrMultisampleTilesX; ++tileX)
+		{
+			if (!m_pTileDecompressed[tileY * m_NrMultisampleTilesX + tileX])
+			{
+				continue;
+			}
+
+			const int maxY{ std::min((tileY + 1) * g_MultisampleTileSize, m_Height) };
+			const int maxX{ std::min((tileX + 1) * g_MultisampleTileSize, m_Width) };
+			for (int py{ tileY * g_MultisampleTileSize }; py < maxY; ++py)
+			{
+				for (int px{ tileX * g_MultisampleTileSize }; px < maxX; ++px)
 				{
-					((((mesh.vertices_out[vertexIndex0].viewDirection / mesh.vertices_out[vertexIndex0].position.w) * weightV0) +
-					((mesh.vertices_out[vertexIndex1].viewDirection / mesh.vertices_out[vertexIndex1].position.w) * weightV1) +
-					((mesh.vertices_out[vertexIndex2].viewDirection / mesh.vertices_out[vertexIndex2].position.w) * weightV2)) * interpolatedPixelDepth).Normalized()
-				};
+					const int index{ px + py * m_Width };
+					if (m_pPixelCompressed[index])
+					{
+						continue;
+					}
+
+					//Box filter the samples, per 8 bit channel
+					const uint32_t* pSamples{ m_pSampleColorBuffer + static_cast<ptrdiff_t>(index) * g_NrSamples };
+					uint32_t resolved{};
+					for (uint32_t shift{}; shift < 32; shift += 8)
+					{
+						uint32_t sum{ g_NrSamples / 2 };
+						for (int sample{}; sample < g_NrSamples; ++sample)
+						{
+							sum += (pSamples[sample] >> shift) & 0xFF;
+						}
+						resolved |= (sum / g_NrSamples) << shift;
+					}
+					m_pBackBufferPixels[index] = resolved;
+				}
 			}
-			PixelShading(pixelInfo);
 		}
 	}
 }
+
+namespace
+{
+	constexpr size_t g_NrCullModes{ 3 };
+	constexpr size_t g_NrRenderModes{ 4 };
+	constexpr size_t g_NrDrawTriangleKernels{ 2 * 2 * g_NrCullModes * 2 * 2 * g_NrRenderModes };
+
+	//Kernel index layout: [multisampled][boundingBox][cullMode][depthBuffer][normal][renderMode]
+	constexpr size_t GetDrawTriangleKernelIndex(bool isMultisampled, bool isBoundingBox, CullMode cullMode, bool isDepthBuffer, bool isNormal, RenderMode renderMode)
+	{
+		return ((((static_cast<size_t>(isMultisampled) * 2 + static_cast<size_t>(isBoundingBox)) * g_NrCullModes + static_cast<size_t>(cullMode)) * 2
+			+ static_cast<size_t>(isDepthBuffer)) * 2
+			+ static_cast<size_t>(isNormal)) * g_NrRenderModes
+			+ static_cast<size_t>(renderMode);
+	}
+
+	constexpr bool GetKernelIsMultisampled(size_t index) { return index / (g_NrRenderModes * 2 * 2 * g_NrCullModes * 2) % 2; }
+	constexpr bool GetKernelIsBoundingBox(size_t index) { return index / (g_NrRenderModes * 2 * 2 * g_NrCullModes) % 2; }
+	constexpr CullMode GetKernelCullMode(size_t index) { return static_cast<CullMode>(index / (g_NrRenderModes * 2 * 2) % g_NrCullModes); }
+	constexpr bool GetKernelIsDepthBuffer(size_t index) { return index / (g_NrRenderModes * 2) % 2; }
+	constexpr bool GetKernelIsNormal(size_t index) { return index / g_NrRenderModes % 2; }
+	constexpr RenderMode GetKernelRenderMode(size_t index) { return static_cast<RenderMode>(index % g_NrRenderModes); }
+}
+
+template<typename Effect, size_t... indices>
+constexpr std::array<SoftwareRenderer::DrawTriangleKernel<Effect>, sizeof...(indices)> SoftwareRenderer::CreateDrawTriangleKernels(std::index_sequence<indices...>)
+{
+	return { &SoftwareRenderer::DrawTriangle<Effect,
+		GetKernelIsMultisampled(indices),
+		GetKernelIsBoundingBox(indices),
+		GetKernelCullMode(indices),
+		GetKernelIsDepthBuffer(indices),
+		GetKernelIsNormal(indices),
+		GetKernelRenderMode(indices)>... };
+}
+
+template<typename Effect>
+SoftwareRenderer::DrawTriangleKernel<Effect> SoftwareRenderer::SelectDrawTriangleKernel() const
+{
+	static constexpr std::array<DrawTriangleKernel<Effect>, g_NrDrawTriangleKernels> kernels{ CreateDrawTriangleKernels<Effect>(std::make_index_sequence<g_NrDrawTriangleKernels>{}) };
+	//Transparent effects render double sided, like the rasterizer state in Fire.fx
+	const CullMode cullMode{ Effect::IsTransparent ? None : *m_pCullMode };
+	return kernels[GetDrawTriangleKernelIndex(m_IsMultisampled, m_IsBoundingBox, cullMode, m_IsDepthBuffer, m_IsNormal, m_Rendermode)];
+}
+
+void SoftwareRenderer::DrawBenchmarkTriangle(const Vector2& screenV0, const Vector2& screenV1, const Vector2& screenV2)
+{
+	const VehicleEffect* pEffect{ nullptr };
+	for (const SoftwareMesh* pMesh : m_pMeshes)
+	{
+		if (const auto pVehicleEffect{ std::get_if<VehicleEffect>(&pMesh->effect) })
+		{
+			pEffect = pVehicleEffect;
+			break;
+		}
+	}
+	if (!pEffect)
+		return;
+
+	ShaderGlobals globals{};
+	globals.cameraOrigin = m_pCamera->origin;
+	if (!m_pLightGrid->IsEmpty())
+	{
+		globals.pLightGrid = m_pLightGrid;
+	}
+
+	//Close to the near plane, so nothing the scene drew hides it
+	constexpr float ndcDepth{ 0.01f };
+	constexpr float viewDepth{ 1.f };
+	constexpr size_t nrFloats{ sizeof(VehicleVaryings) / sizeof(float) };
+	if (m_VerticesProjected.size() < 3)
+	{
+		m_VerticesProjected.resize(3);
+	}
+	if (m_VerticesVaryings.size() < 3 * nrFloats)
+	{
+		m_VerticesVaryings.resize(3 * nrFloats);
+	}
+	m_VerticesProjected[0] = { screenV0.x, screenV0.y, ndcDepth, viewDepth };
+	m_VerticesProjected[1] = { screenV1.x, screenV1.y, ndcDepth, viewDepth };
+	m_VerticesProjected[2] = { screenV2.x, screenV2.y, ndcDepth, viewDepth };
+
+	//Facing the directional light, with the uvs spread over most of the textures
+	VehicleVaryings* pVaryings{ reinterpret_cast<VehicleVaryings*>(m_VerticesVaryings.data()) };
+	constexpr Vector2 uvs[3]{ { 0.05f, 0.05f }, { 0.95f, 0.05f }, { 0.05f, 0.95f } };
+	for (int i{}; i < 3; ++i)
+	{
+		pVaryings[i].uv = uvs[i];
+		pVaryings[i].normal = -globals.lightDirection.Normalized();
+		pVaryings[i].tangent = Vector3::Cross(pVaryings[i].normal, Vector3::UnitY).Normalized();
+		pVaryings[i].viewDirection = { 0.f, 0.f, viewDepth };
+	}
+
+	SDL_LockSurface(m_pBackBuffer);
+	(this->*SelectDrawTriangleKernel<VehicleEffect>())(*pEffect, globals, pVaryings, 0, 1, 2);
+	SDL_UnlockSurface(m_pBackBuffer);
+}
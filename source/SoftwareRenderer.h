@@ -1,27 +1,43 @@
 #pragma once
+#include <array>
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <utility>
 
 #include "Camera.h"
 #include "DataTypes.h"
+#include "DynamicResolution.h"
+#include "FrameCapture.h"
+#include "SoftwareEffect.h"
+#include "SoftwarePixelFormat.h"
 #include "SoftwareTexture.h"
 #include "GlobalDefinitions.h"
 
 using namespace dae;
 
+//Every toggle of the software renderer at once, the interactive keys flip them one by one
+struct SoftwareRenderSettings
+{
+	RenderMode renderMode{ RenderMode::Combined };
+	bool isNormal{ true };
+	bool isDepthBuffer{ false };
+	bool isBoundingBox{ false };
+	bool isUniformClearColor{ true };
+	bool showFireMesh{ true };
+	bool isRotating{ true };
+	bool isMultisampled{ false };
+	bool isDynamicResolution{ false };
+	bool isVariableRateShading{ false };
+	bool isMeshletCulling{ true };
+};
+
 class SoftwareRenderer
 {
 public:
-	enum RenderMode
-	{
-		ObservedArea,
-		Diffuse,
-		Specular,
-		Combined
-	};
-
-	SoftwareRenderer(SDL_Window* pWindow, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode);
+	SoftwareRenderer(SDL_Window* pWindow, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode, AssetCache* pAssetCache);
+	//Offscreen, renders into a surface of its own so it needs neither a window nor the SDL video subsystem
+	SoftwareRenderer(int width, int height, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode, AssetCache* pAssetCache);
 	~SoftwareRenderer();
 
 	SoftwareRenderer(const SoftwareRenderer&) = delete;
@@ -29,8 +45,13 @@ public:
 	SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
 	SoftwareRenderer& operator=(SoftwareRenderer&&) noexcept = delete;
 
-	void Update(const Timer* pTimer) const;
+	void Update(const Timer* pTimer) { Update(pTimer->GetElapsed()); }
+	void Update(float elapsedSec);
 	void Render();
+
+	void ApplySettings(const SoftwareRenderSettings& settings);
+	//Final image of the last frame at full resolution, the window surface when there is a window
+	const SDL_Surface* GetFrontBuffer() const { return m_pFrontBuffer; }
 	void ToggleDepthBuffer()
 	{
 		m_IsDepthBuffer = !m_IsDepthBuffer;
@@ -62,55 +83,173 @@ public:
 		}
 	}
 	void ToggleClearCollor() { m_ClearColor = !m_ClearColor; }
+	void ToggleFireMesh() { m_ShowFireMesh = !m_ShowFireMesh; }
+	void ToggleMultisampling()
+	{
+		m_IsMultisampled = !m_IsMultisampled;
+		if (m_IsMultisampled) { std::cout << "ON"; }
+		else { std::cout << "OFF"; }
+	}
+	void ToggleDynamicResolution();
+	void ToggleVariableRateShading();
+	void ToggleMeshletCulling()
+	{
+		m_IsMeshletCulling = !m_IsMeshletCulling;
+		if (m_IsMeshletCulling) { std::cout << "ON"; }
+		else { std::cout << "OFF"; }
+	}
+
+	//Point and spot lights, assigned to clusters every frame
+	void AddLight(const Light& light) { m_Lights.push_back(light); }
+	void ClearLights() { m_Lights.clear(); }
 
+	//Queues the last presented frame as Screenshot_<n>.png, false when the capture had to be dropped
 	bool SaveBufferToImage() const;
+	//Captures every Nth presented frame to <pathPrefix><frame><extension>, 0 turns it off
+	void SetCaptureInterval(int everyNthFrame, const std::string& pathPrefix, const std::string& extension = ".png");
+	FrameCapture& GetFrameCapture() const { return *m_pFrameCapture; }
+
+	//One screen space triangle through the vehicle raster kernel of the current toggles, for the micro benchmarks.
+	//It is drawn in front of the scene, and a redraw of the same triangle passes the depth test, so every call shades all its pixels.
+	void DrawBenchmarkTriangle(const Vector2& screenV0, const Vector2& screenV1, const Vector2& screenV2);
 
 private:
 	SDL_Window* m_pWindow{};
+	bool m_IsOffscreen{ false };
 
 	SDL_Surface* m_pFrontBuffer{ nullptr };
 	SDL_Surface* m_pBackBuffer{ nullptr };
 	uint32_t* m_pBackBufferPixels{};
+	//Packs shaded colors in the raster loop, SDL_MapRGB would be a call per pixel
+	PixelFormat m_BackBufferFormat{};
 
 	float* m_pDepthBufferPixels{};
 
+	//One row of transparent pixels waiting to be blended, BlendSpan leaves the alpha at zero for the next row
+	uint32_t* m_pBlendSpanColors{};
+	uint8_t* m_pBlendSpanAlpha{};
+	std::vector<std::pair<float, uint32_t>> m_SortedTriangles{};
+
+	//4x MSAA: depth per sample, colors per sample only for pixels that aren't fully covered by one triangle
+	float* m_pSampleDepthBuffer{};
+	uint32_t* m_pSampleColorBuffer{};
+	uint8_t* m_pPixelCompressed{};
+	uint8_t* m_pTileDecompressed{};
+	int m_NrMultisampleTilesX{};
+
 	Camera* m_pCamera{};
 	CullMode* m_pCullMode{};
+	AssetCache* m_pAssetCache{};
 
 	SoftwareTexture* m_pTexture{ nullptr };
 	SoftwareTexture* m_pTextureGloss{ nullptr };
 	SoftwareTexture* m_pTextureNormal{ nullptr };
 	SoftwareTexture* m_pTextureSpecular{ nullptr };
+	SoftwareTexture* m_pTextureFire{ nullptr };
 
+	//Render resolution, every buffer is allocated for the window size so a change never reallocates
 	int m_Width{};
 	int m_Height{};
+	int m_MaxWidth{};
+	int m_MaxHeight{};
 	float m_AspectRatio{};
 
+	struct UpscaleTap
+	{
+		int x0{};
+		int x1{};
+		uint32_t weight{};
+	};
+
+	DynamicResolution* m_pDynamicResolution{ nullptr };
+	SDL_Surface* m_pUpscaleBuffer{ nullptr };
+	std::vector<UpscaleTap> m_UpscaleTaps{};
+
+	//Encodes on its own thread, the render loop only pays for the copy
+	FrameCapture* m_pFrameCapture{ nullptr };
+	int m_CaptureInterval{};
+	std::string m_CapturePathPrefix{};
+	std::string m_CaptureExtension{};
+	uint32_t m_FrameIndex{};
+	mutable uint32_t m_NrScreenshots{};
+
+	//Variable rate shading: a rate per screen tile and the last coarse color shaded in every column
+	struct CoarseShade
+	{
+		uint32_t triangle{};
+		int blockY{};
+		ColorRGB color{};
+	};
+
+	uint8_t* m_pShadingRates{};
+	int m_NrShadingRateTilesX{};
+	int m_NrShadingRateTiles{};
+	CoarseShade* m_pCoarseShades{};
+	mutable uint32_t m_CoarseShadeStamp{};
+
 	bool m_IsRotating{ true };
 	bool m_IsNormal{ true };
 	bool m_IsDepthBuffer{ false };
 	bool m_IsBoundingBox{ false };
 	bool m_ClearColor{ true };
+	bool m_ShowFireMesh{ true };
+	bool m_IsMultisampled{ false };
+	bool m_IsDynamicResolution{ false };
+	bool m_IsVariableRateShading{ false };
+	bool m_IsMeshletCulling{ true };
 	RenderMode m_Rendermode{ RenderMode::Combined };
 
 	std::vector<GlobalMesh*>& m_pGlobalMeshes;
-	std::vector<Mesh> m_MeshesWorld{};
-	size_t m_VerticesCount{};
-	Vertex_In* m_VerticesWorld;
-	Vertex_In* m_VerticesNDC;
-	Vector2* m_VerticesScreenSpace;
+	std::vector<SoftwareMesh*> m_pMeshes{};
+
+	std::vector<Light> m_Lights{};
+	LightGrid* m_pLightGrid{ nullptr };
 
-	void LoadMesh(const std::string& path);
-	void VertexTransformationWorldToNDCNew(Mesh& mesh) const;
+	//Vertex stage output: screen space xy, ndc depth and view depth (w)
+	std::vector<Vector4> m_VerticesProjected{};
+	//Vertex stage output: interpolants, typed by the effect that is drawing
+	std::vector<float> m_VerticesVaryings{};
 
-	static bool IsVerticesInFrustrum(const Vertex_Out& vertex);
-	void PixelShading(const Vertex_Out& v) const;
-	void CalculateSpecular(const Vector3& sampledNormal, const Vector3& lightDirection, const Vertex_Out& v, float shininess, ColorRGB& output) const;
+	//Meshlets that survived culling, vertices shared by several of them are only transformed once
+	std::vector<uint32_t> m_VisibleMeshlets{};
+	std::vector<uint32_t> m_VertexStamps{};
+	uint32_t m_VertexStamp{};
 
-	//Draw traingles by using the index
-	void DrawTriangle(int i, bool swapVertices, const Mesh& mesh) const;
+	SoftwareRenderer(SDL_Window* pWindow, int width, int height, std::vector<GlobalMesh*>& pGlobalMeshes, Camera* pCamera, CullMode* pCullMode, AssetCache* pAssetCache);
+
+	void LoadMesh(const std::string& path, GlobalMesh* pGlobalMesh, const SoftwareEffectVariant& effect);
+
+	template<typename Effect>
+	void RenderMesh(const SoftwareMesh& softwareMesh, const Effect& effect);
+	template<typename Effect>
+	const typename Effect::Varyings* VertexTransformationWorldToScreen(const SoftwareMesh& softwareMesh, const Effect& effect, const ShaderGlobals& globals, bool isMeshletCulled);
+
+	//Fills m_VisibleMeshlets with the meshlets inside the frustum that have at least one triangle facing the right way
+	void CullMeshlets(const SoftwareMesh& softwareMesh, CullMode cullMode);
+
+	bool IsVerticesInFrustrum(const Vector4& vertex) const;
+
+	//Draw traingles by using the index, every toggle is baked into the instantiation
+	template<typename Effect, bool isMultisampled, bool isBoundingBox, CullMode cullMode, bool isDepthBuffer, bool isNormal, RenderMode renderMode>
+	void DrawTriangle(const Effect& effect, const ShaderGlobals& globals, const typename Effect::Varyings* pVaryings, uint32_t vertexIndex0, uint32_t vertexIndex1, uint32_t vertexIndex2) const;
+
+	void SetRenderResolution(int width, int height);
+	void UpscaleToWindow() const;
+	//Copies the image that was blitted to the front buffer, the back buffer or its upscale
+	bool CapturePresentedFrame(std::string path) const;
+	void UpdateShadingRates() const;
+
+	void DecompressPixel(int px, int py) const;
+	void ResolveMultisampling() const;
+
+	//Kernel table with one DrawTriangle instantiation per effect and toggle combination
+	template<typename Effect>
+	using DrawTriangleKernel = void (SoftwareRenderer::*)(const Effect&, const ShaderGlobals&, const typename Effect::Varyings*, uint32_t, uint32_t, uint32_t) const;
+	template<typename Effect, size_t... indices>
+	static constexpr std::array<DrawTriangleKernel<Effect>, sizeof...(indices)> CreateDrawTriangleKernels(std::index_sequence<indices...>);
+	template<typename Effect>
+	DrawTriangleKernel<Effect> SelectDrawTriangleKernel() const;
 
 	//Find size to reserve
 	size_t FindReserveSize() const;
 };
-
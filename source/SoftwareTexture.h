@@ -1,7 +1,11 @@
 #pragma once
 #include <SDL_surface.h>
+#include <algorithm>
+#include <memory>
 #include <string>
+#include "AssetCache.h"
 #include "ColorRGB.h"
+#include "SoftwarePixelFormat.h"
 #include "Vector3.h"
 
 namespace dae
@@ -11,51 +15,45 @@ namespace dae
 	class SoftwareTexture final
 	{
 	public:
-		~SoftwareTexture()
+		static SoftwareTexture* LoadFromFile(AssetCache& assets, const std::string& path)
 		{
-			if (m_pSurface)
-			{
-				SDL_FreeSurface(m_pSurface);
-				m_pSurface = nullptr;
-			}
+			//The decoded image is shared with the hardware textures
+			return new SoftwareTexture{ assets.LoadSurface(path) };
 		}
 
-		static SoftwareTexture* LoadFromFile(const std::string& path)
+		MATH_INLINE ColorRGB Sample(const Vector2& uv) const
 		{
-			//Load SDL_Surface using IMG_LOAD
-			return new SoftwareTexture{ IMG_Load(path.c_str()) };
-		}
-
-		ColorRGB Sample(const Vector2& uv) const
-		{
-			//Set x & y for later usage
-			const int x = static_cast<int>(uv.x * m_pSurface->w);
-			const int y = static_cast<int>(uv.y * m_pSurface->h);
-
-			//Prepare color get & calculate pixel index on texture
-			const Uint32 pixel = m_pSurfacePixels[x + y * m_pSurface->w];
+			const Uint32 pixel = GetPixel(uv);
 			Uint8 r{}, g{}, b{};
 
 			//Get RGB color from texture
-			SDL_GetRGB(pixel, m_pSurface->format, &r, &g, &b);
+			m_Format.GetRGB(pixel, r, g, b);
 
 			//Convert to colorRGB
 			constexpr float maxColorValue = 255.f;
 			return ColorRGB{ r / maxColorValue, g / maxColorValue, b / maxColorValue };
 		}
 
-		Vector3 SampleToVector(const Vector2& uv) const
+		MATH_INLINE ColorRGB SampleRGBA(const Vector2& uv) const
 		{
-			//Set x & y for later usage
-			const int x = static_cast<int>(uv.x * m_pSurface->w);
-			const int y = static_cast<int>(uv.y * m_pSurface->h);
+			const Uint32 pixel = GetPixel(uv);
+			Uint8 r{}, g{}, b{}, a{};
 
-			//Prepare color get & calculate pixel index on texture
-			const Uint32 pixel = m_pSurfacePixels[x + y * m_pSurface->w];
+			//Get RGBA color from texture
+			m_Format.GetRGBA(pixel, r, g, b, a);
+
+			//Convert to colorRGB
+			constexpr float maxColorValue = 255.f;
+			return ColorRGB{ r / maxColorValue, g / maxColorValue, b / maxColorValue, a / maxColorValue };
+		}
+
+		MATH_INLINE Vector3 SampleToVector(const Vector2& uv) const
+		{
+			const Uint32 pixel = GetPixel(uv);
 			Uint8 r{}, g{}, b{};
 
 			//Get RGB color from texture
-			SDL_GetRGB(pixel, m_pSurface->format, &r, &g, &b);
+			m_Format.GetRGB(pixel, r, g, b);
 
 			//Convert to colorRGB
 			constexpr float maxColorValue = 255.f;
@@ -63,14 +61,24 @@ namespace dae
 		}
 
 	private:
+		//Clamped to the edge texels, interpolated uvs of edge on triangles land just outside 0-1
+		MATH_INLINE Uint32 GetPixel(const Vector2& uv) const
+		{
+			const int x = std::clamp(static_cast<int>(uv.x * m_pSurface->w), 0, m_pSurface->w - 1);
+			const int y = std::clamp(static_cast<int>(uv.y * m_pSurface->h), 0, m_pSurface->h - 1);
+			return m_pSurfacePixels[x + y * m_pSurface->w];
+		}
+
 		//Constructor
-		SoftwareTexture(SDL_Surface* pSurface) :
-			m_pSurface{ pSurface },
-			m_pSurfacePixels{ static_cast<uint32_t*>(pSurface->pixels) }
+		SoftwareTexture(std::shared_ptr<SDL_Surface> pSurface) :
+			m_pSurface{ std::move(pSurface) },
+			m_pSurfacePixels{ static_cast<uint32_t*>(m_pSurface->pixels) },
+			m_Format{ *m_pSurface->format }
 		{
 		}
 
-		SDL_Surface* m_pSurface{ nullptr };
+		std::shared_ptr<SDL_Surface> m_pSurface{ nullptr };
 		uint32_t* m_pSurfacePixels{ nullptr };
+		PixelFormat m_Format{};
 	};
 }
\ No newline at end of file
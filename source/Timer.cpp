@@ -7,6 +7,14 @@ namespace dae
 	{
 		const uint64_t countsPerSecond = SDL_GetPerformanceFrequency();
 		m_SecondsPerCount = 1.0f / static_cast<float>(countsPerSecond);
+		m_CountsPerSecond = countsPerSecond;
+	}
+
+	uint64_t Timer::ToNanoseconds(uint64_t counts) const
+	{
+		//Whole seconds first, counts * 1e9 alone overflows after a few minutes on a 10 MHz counter
+		constexpr uint64_t nanosecondsPerSecond{ 1'000'000'000 };
+		return counts / m_CountsPerSecond * nanosecondsPerSecond + counts % m_CountsPerSecond * nanosecondsPerSecond / m_CountsPerSecond;
 	}
 
 	void Timer::Reset()
@@ -19,6 +27,7 @@ namespace dae
 		m_FPSTimer = 0.0f;
 		m_FPSCount = 0;
 		m_IsStopped = false;
+		m_FrameHistory.Clear();
 	}
 
 	void Timer::Start()
@@ -48,6 +57,9 @@ namespace dae
 		const uint64_t currentTime = SDL_GetPerformanceCounter();
 		m_CurrentTime = currentTime;
 
+		//Unclamped and in integer nanoseconds, the history has to show the real frame time
+		m_FrameHistory.Add(ToNanoseconds(m_CurrentTime - m_PausedTime - m_BaseTime), ToNanoseconds(m_CurrentTime - m_PreviousTime));
+
 		m_ElapsedTime = static_cast<float>(m_CurrentTime - m_PreviousTime) * m_SecondsPerCount;
 		m_PreviousTime = m_CurrentTime;
 
@@ -3,6 +3,8 @@
 //Standard includes
 #include <cstdint>
 
+#include "FrameHistory.h"
+
 namespace dae
 {
 	class Timer
@@ -27,6 +29,10 @@ namespace dae
 		float GetTotal() const { return m_TotalTime; };
 		bool IsRunning() const { return !m_IsStopped; };
 
+		//Integer nanosecond frame times of the last frames, the stats are over the last nrFrames of them
+		const FrameHistory& GetFrameHistory() const { return m_FrameHistory; };
+		FrameStats GetFrameStats(size_t nrFrames) const { return m_FrameHistory.Calculate(nrFrames); };
+
 	private:
 		uint64_t m_BaseTime = 0;
 		uint64_t m_PausedTime = 0;
@@ -44,7 +50,12 @@ namespace dae
 		float m_ElapsedUpperBound = 0.03f;
 		float m_FPSTimer = 0.0f;
 
+		uint64_t m_CountsPerSecond = 1;
+		FrameHistory m_FrameHistory{};
+
 		bool m_IsStopped = true;
 		bool m_ForceElapsedUpperBound = false;
+
+		uint64_t ToNanoseconds(uint64_t counts) const;
 	};
 }
\ No newline at end of file
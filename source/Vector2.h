@@ -1,4 +1,9 @@
 #pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "MathConfig.h"
 
 namespace dae
 {
@@ -8,43 +13,143 @@ namespace dae
 		float y{};
 
 		Vector2() = default;
-		Vector2(float _x, float _y);
-		Vector2(const Vector2& from, const Vector2& to);
+		constexpr Vector2(float _x, float _y) noexcept : x(_x), y(_y) {}
+		constexpr Vector2(const Vector2& from, const Vector2& to) noexcept : x(to.x - from.x), y(to.y - from.y) {}
+
+		MATH_INLINE float Magnitude() const noexcept
+		{
+			return sqrtf(x * x + y * y);
+		}
+
+		MATH_INLINE constexpr float SqrMagnitude() const noexcept
+		{
+			return x * x + y * y;
+		}
+
+		MATH_INLINE float Normalize() noexcept
+		{
+			const float m = Magnitude();
+			x /= m;
+			y /= m;
+
+			return m;
+		}
 
-		float Magnitude() const;
-		float SqrMagnitude() const;
-		float Normalize();
-		Vector2 Normalized() const;
-		void Clamp(float minX, float minY, float maxX, float maxY);
-		void Clamp(float maxX, float maxY);
+		MATH_INLINE Vector2 Normalized() const noexcept
+		{
+			const float m = Magnitude();
+			return { x / m, y / m };
+		}
 
+		constexpr void Clamp(float minX, float minY, float maxX, float maxY) noexcept
+		{
+			x = std::clamp(x, minX, maxX);
+			y = std::clamp(y, minY, maxY);
+		}
 
-		static float Dot(const Vector2& v1, const Vector2& v2);
-		static float Cross(const Vector2& v1, const Vector2& v2);
-		static Vector2 Min(const Vector2& v1, const Vector2& v2);
-		static Vector2 Max(const Vector2& v1, const Vector2& v2);
+		constexpr void Clamp(float maxX, float maxY) noexcept
+		{
+			x = std::clamp(x, 0.f, maxX);
+			y = std::clamp(y, 0.f, maxY);
+		}
+
+		MATH_INLINE static constexpr float Dot(const Vector2& v1, const Vector2& v2) noexcept
+		{
+			return v1.x * v2.x + v1.y * v2.y;
+		}
+
+		MATH_INLINE static constexpr float Cross(const Vector2& v1, const Vector2& v2) noexcept
+		{
+			return v1.x * v2.y - v1.y * v2.x;
+		}
+
+		MATH_INLINE static constexpr Vector2 Min(const Vector2& v1, const Vector2& v2) noexcept
+		{
+			return { std::min(v1.x, v2.x), std::min(v1.y, v2.y) };
+		}
+
+		MATH_INLINE static constexpr Vector2 Max(const Vector2& v1, const Vector2& v2) noexcept
+		{
+			return { std::max(v1.x, v2.x), std::max(v1.y, v2.y) };
+		}
 
 		//Member Operators
-		Vector2 operator*(float scale) const;
-		Vector2 operator/(float scale) const;
-		Vector2 operator+(const Vector2& v) const;
-		Vector2 operator-(const Vector2& v) const;
-		Vector2 operator-() const;
-		//Vector2& operator-();
-		Vector2& operator+=(const Vector2& v);
-		Vector2& operator-=(const Vector2& v);
-		Vector2& operator/=(float scale);
-		Vector2& operator*=(float scale);
-		float& operator[](int index);
-		float operator[](int index) const;
+		MATH_INLINE constexpr Vector2 operator*(float scale) const noexcept
+		{
+			return { x * scale, y * scale };
+		}
+
+		MATH_INLINE constexpr Vector2 operator/(float scale) const noexcept
+		{
+			return { x / scale, y / scale };
+		}
+
+		MATH_INLINE constexpr Vector2 operator+(const Vector2& v) const noexcept
+		{
+			return { x + v.x, y + v.y };
+		}
+
+		MATH_INLINE constexpr Vector2 operator-(const Vector2& v) const noexcept
+		{
+			return { x - v.x, y - v.y };
+		}
+
+		MATH_INLINE constexpr Vector2 operator-() const noexcept
+		{
+			return { -x ,-y };
+		}
+
+		MATH_INLINE constexpr Vector2& operator+=(const Vector2& v) noexcept
+		{
+			x += v.x;
+			y += v.y;
+			return *this;
+		}
+
+		MATH_INLINE constexpr Vector2& operator-=(const Vector2& v) noexcept
+		{
+			x -= v.x;
+			y -= v.y;
+			return *this;
+		}
+
+		MATH_INLINE constexpr Vector2& operator/=(float scale) noexcept
+		{
+			x /= scale;
+			y /= scale;
+			return *this;
+		}
+
+		MATH_INLINE constexpr Vector2& operator*=(float scale) noexcept
+		{
+			x *= scale;
+			y *= scale;
+			return *this;
+		}
+
+		constexpr float& operator[](int index) noexcept
+		{
+			assert(index <= 1 && index >= 0);
+			return index == 0 ? x : y;
+		}
+
+		constexpr float operator[](int index) const noexcept
+		{
+			assert(index <= 1 && index >= 0);
+			return index == 0 ? x : y;
+		}
 
 		static const Vector2 UnitX;
 		static const Vector2 UnitY;
 		static const Vector2 Zero;
 	};
 
+	inline constexpr Vector2 Vector2::UnitX{ 1, 0 };
+	inline constexpr Vector2 Vector2::UnitY{ 0, 1 };
+	inline constexpr Vector2 Vector2::Zero{ 0, 0 };
+
 	//Global Operators
-	inline Vector2 operator*(float scale, const Vector2& v)
+	MATH_INLINE constexpr Vector2 operator*(float scale, const Vector2& v) noexcept
 	{
 		return { v.x * scale, v.y * scale };
 	}
@@ -1,8 +1,9 @@
 #pragma once
+#include "MathHelpers.h"
+#include "Vector2.h"
 
 namespace dae
 {
-	struct Vector2;
 	struct Vector4;
 	struct Vector3
 	{
@@ -11,40 +12,186 @@ namespace dae
 		float z{};
 
 		Vector3() = default;
-		Vector3(float _x, float _y, float _z);
-		Vector3(const Vector3& from, const Vector3& to);
-		Vector3(const Vector4& v);
+		constexpr Vector3(float _x, float _y, float _z) noexcept : x(_x), y(_y), z(_z) {}
+		constexpr Vector3(const Vector3& from, const Vector3& to) noexcept : x(to.x - from.x), y(to.y - from.y), z(to.z - from.z) {}
+		constexpr Vector3(const Vector4& v) noexcept;
 
-		float Magnitude() const;
-		float SqrMagnitude() const;
-		float Normalize();
-		Vector3 Normalized() const;
+		MATH_INLINE float Magnitude() const noexcept
+		{
+			return sqrtf(x * x + y * y + z * z);
+		}
 
-		static float Dot(const Vector3& v1, const Vector3& v2);
-		static float DotClamp(const Vector3& v1, const Vector3& v2);
-		static Vector3 Cross(const Vector3& v1, const Vector3& v2);
-		static Vector3 Project(const Vector3& v1, const Vector3& v2);
-		static Vector3 Reject(const Vector3& v1, const Vector3& v2);
-		static Vector3 Reflect(const Vector3& v1, const Vector3& v2);
+		MATH_INLINE constexpr float SqrMagnitude() const noexcept
+		{
+			return x * x + y * y + z * z;
+		}
 
-		Vector4 ToPoint4() const;
-		Vector4 ToVector4() const;
+		//The precision policy trades the sqrt and divides for a reciprocal square root estimate
+		template<typename Precision = ExactPrecision>
+		MATH_INLINE float Normalize() noexcept
+		{
+			if constexpr (Precision::IsExact)
+			{
+				const float m = Magnitude();
+				x /= m;
+				y /= m;
+				z /= m;
 
-		Vector2 GetXY() const;
+				return m;
+			}
+			else
+			{
+				const float sqrMagnitude{ SqrMagnitude() };
+				const float invMagnitude{ Precision::InvSqrt(sqrMagnitude) };
+				*this *= invMagnitude;
+
+				return sqrMagnitude * invMagnitude;
+			}
+		}
+
+		template<typename Precision = ExactPrecision>
+		MATH_INLINE Vector3 Normalized() const noexcept
+		{
+			if constexpr (Precision::IsExact)
+			{
+				const float m = Magnitude();
+				return { x / m, y / m, z / m };
+			}
+			else
+			{
+				return *this * Precision::InvSqrt(SqrMagnitude());
+			}
+		}
+
+		MATH_INLINE static constexpr float Dot(const Vector3& v1, const Vector3& v2) noexcept
+		{
+			return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z;
+		}
+
+		MATH_INLINE static constexpr float DotClamp(const Vector3& v1, const Vector3& v2) noexcept
+		{
+			return std::max(0.f, Dot(v1, v2));
+		}
+
+		MATH_INLINE static constexpr Vector3 Cross(const Vector3& v1, const Vector3& v2) noexcept
+		{
+			return Vector3{
+				v1.y * v2.z - v1.z * v2.y,
+				v1.z * v2.x - v1.x * v2.z,
+				v1.x * v2.y - v1.y * v2.x
+			};
+		}
+
+		MATH_INLINE static constexpr Vector3 Project(const Vector3& v1, const Vector3& v2) noexcept
+		{
+			return (v2 * (Dot(v1, v2) / Dot(v2, v2)));
+		}
+
+		MATH_INLINE static constexpr Vector3 Reject(const Vector3& v1, const Vector3& v2) noexcept
+		{
+			return (v1 - v2 * (Dot(v1, v2) / Dot(v2, v2)));
+		}
+
+		MATH_INLINE static constexpr Vector3 Reflect(const Vector3& v1, const Vector3& v2) noexcept
+		{
+			return v1 - v2 * (2.f * Dot(v1, v2));
+		}
+
+		MATH_INLINE static constexpr Vector3 Min(const Vector3& v1, const Vector3& v2) noexcept
+		{
+			return { std::min(v1.x, v2.x), std::min(v1.y, v2.y), std::min(v1.z, v2.z) };
+		}
+
+		MATH_INLINE static constexpr Vector3 Max(const Vector3& v1, const Vector3& v2) noexcept
+		{
+			return { std::max(v1.x, v2.x), std::max(v1.y, v2.y), std::max(v1.z, v2.z) };
+		}
+
+		constexpr Vector4 ToPoint4() const noexcept;
+		constexpr Vector4 ToVector4() const noexcept;
+
+		MATH_INLINE constexpr Vector2 GetXY() const noexcept
+		{
+			return { x, y };
+		}
 
 		//Member Operators
-		Vector3 operator*(float scale) const;
-		Vector3 operator/(float scale) const;
-		Vector3 operator+(const Vector3& v) const;
-		Vector3 operator-(const Vector3& v) const;
-		Vector3 operator-() const;
-		//Vector3& operator-();
-		Vector3& operator+=(const Vector3& v);
-		Vector3& operator-=(const Vector3& v);
-		Vector3& operator/=(float scale);
-		Vector3& operator*=(float scale);
-		float& operator[](int index);
-		float operator[](int index) const;
+		MATH_INLINE constexpr Vector3 operator*(float scale) const noexcept
+		{
+			return { x * scale, y * scale, z * scale };
+		}
+
+		MATH_INLINE constexpr Vector3 operator/(float scale) const noexcept
+		{
+			return { x / scale, y / scale, z / scale };
+		}
+
+		MATH_INLINE constexpr Vector3 operator+(const Vector3& v) const noexcept
+		{
+			return { x + v.x, y + v.y, z + v.z };
+		}
+
+		MATH_INLINE constexpr Vector3 operator-(const Vector3& v) const noexcept
+		{
+			return { x - v.x, y - v.y, z - v.z };
+		}
+
+		MATH_INLINE constexpr Vector3 operator-() const noexcept
+		{
+			return { -x ,-y,-z };
+		}
+
+		constexpr bool operator==(const Vector3& v) const noexcept = default;
+
+		MATH_INLINE constexpr Vector3& operator+=(const Vector3& v) noexcept
+		{
+			x += v.x;
+			y += v.y;
+			z += v.z;
+			return *this;
+		}
+
+		MATH_INLINE constexpr Vector3& operator-=(const Vector3& v) noexcept
+		{
+			x -= v.x;
+			y -= v.y;
+			z -= v.z;
+			return *this;
+		}
+
+		MATH_INLINE constexpr Vector3& operator/=(float scale) noexcept
+		{
+			x /= scale;
+			y /= scale;
+			z /= scale;
+			return *this;
+		}
+
+		MATH_INLINE constexpr Vector3& operator*=(float scale) noexcept
+		{
+			x *= scale;
+			y *= scale;
+			z *= scale;
+			return *this;
+		}
+
+		constexpr float& operator[](int index) noexcept
+		{
+			assert(index <= 2 && index >= 0);
+
+			if (index == 0) return x;
+			if (index == 1) return y;
+			return z;
+		}
+
+		constexpr float operator[](int index) const noexcept
+		{
+			assert(index <= 2 && index >= 0);
+
+			if (index == 0) return x;
+			if (index == 1) return y;
+			return z;
+		}
 
 		static const Vector3 UnitX;
 		static const Vector3 UnitY;
@@ -53,9 +200,18 @@ namespace dae
 		static const Vector3 One;
 	};
 
+	inline constexpr Vector3 Vector3::UnitX{ 1, 0, 0 };
+	inline constexpr Vector3 Vector3::UnitY{ 0, 1, 0 };
+	inline constexpr Vector3 Vector3::UnitZ{ 0, 0, 1 };
+	inline constexpr Vector3 Vector3::Zero{ 0, 0, 0 };
+	inline constexpr Vector3 Vector3::One{ 1, 1, 1 };
+
 	//Global Operators
-	inline Vector3 operator*(float scale, const Vector3& v)
+	MATH_INLINE constexpr Vector3 operator*(float scale, const Vector3& v) noexcept
 	{
 		return { v.x * scale, v.y * scale, v.z * scale };
 	}
 }
+
+//The Vector4 conversions are defined there, once both types are complete
+#include "Vector4.h"
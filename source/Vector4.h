@@ -1,10 +1,12 @@
 #pragma once
+#include <type_traits>
+
+#include "Vector3.h"
 
 namespace dae
 {
-	struct Vector2;
-	struct Vector3;
-	struct Vector4
+	//16 byte aligned so the four floats load straight into an SSE register
+	struct alignas(16) Vector4
 	{
 		float x;
 		float y;
@@ -12,25 +14,121 @@ namespace dae
 		float w;
 
 		Vector4() = default;
-		Vector4(float _x, float _y, float _z, float _w);
-		Vector4(const Vector3& v, float _w);
-
-		float Magnitude() const;
-		float SqrMagnitude() const;
-		float Normalize();
-		Vector4 Normalized() const;
-
-		Vector2 GetXY() const;
-		Vector3 GetXYZ() const;
-
-		static float Dot(const Vector4& v1, const Vector4& v2);
-
-		// operator overloading
-		Vector4 operator*(float scale) const;
-		Vector4 operator+(const Vector4& v) const;
-		Vector4 operator-(const Vector4& v) const;
-		Vector4& operator+=(const Vector4& v);
-		float& operator[](int index);
-		float operator[](int index) const;
+		constexpr Vector4(float _x, float _y, float _z, float _w) noexcept : x(_x), y(_y), z(_z), w(_w) {}
+		constexpr Vector4(const Vector3& v, float _w) noexcept : x(v.x), y(v.y), z(v.z), w(_w) {}
+
+		MATH_INLINE float Magnitude() const noexcept
+		{
+			return sqrtf(x * x + y * y + z * z + w * w);
+		}
+
+		MATH_INLINE constexpr float SqrMagnitude() const noexcept
+		{
+			return x * x + y * y + z * z + w * w;
+		}
+
+		MATH_INLINE float Normalize() noexcept
+		{
+			const float m = Magnitude();
+			x /= m;
+			y /= m;
+			z /= m;
+			w /= m;
+
+			return m;
+		}
+
+		MATH_INLINE Vector4 Normalized() const noexcept
+		{
+			const float m = Magnitude();
+			return { x / m, y / m, z / m, w / m };
+		}
+
+		MATH_INLINE constexpr Vector2 GetXY() const noexcept
+		{
+			return { x, y };
+		}
+
+		MATH_INLINE constexpr Vector3 GetXYZ() const noexcept
+		{
+			return { x, y, z };
+		}
+
+		MATH_INLINE static constexpr float Dot(const Vector4& v1, const Vector4& v2) noexcept
+		{
+			return v1.x * v2.x + v1.y * v2.y + v1.z * v2.z + v1.w * v2.w;
+		}
+
+#ifdef MATH_SSE
+		MATH_INLINE explicit Vector4(__m128 v) noexcept { _mm_store_ps(&x, v); }
+		MATH_INLINE __m128 Load() const noexcept { return _mm_load_ps(&x); }
+#endif
+
+		//The SSE paths only run outside constant evaluation, both paths give the same bits
+		MATH_INLINE constexpr Vector4 operator*(float scale) const noexcept
+		{
+#ifdef MATH_SSE
+			if (!std::is_constant_evaluated())
+				return Vector4{ _mm_mul_ps(Load(), _mm_set1_ps(scale)) };
+#endif
+			return { x * scale, y * scale, z * scale, w * scale };
+		}
+
+		MATH_INLINE constexpr Vector4 operator+(const Vector4& v) const noexcept
+		{
+#ifdef MATH_SSE
+			if (!std::is_constant_evaluated())
+				return Vector4{ _mm_add_ps(Load(), v.Load()) };
+#endif
+			return { x + v.x, y + v.y, z + v.z, w + v.w };
+		}
+
+		MATH_INLINE constexpr Vector4 operator-(const Vector4& v) const noexcept
+		{
+#ifdef MATH_SSE
+			if (!std::is_constant_evaluated())
+				return Vector4{ _mm_sub_ps(Load(), v.Load()) };
+#endif
+			return { x - v.x, y - v.y, z - v.z, w - v.w };
+		}
+
+		MATH_INLINE constexpr Vector4& operator+=(const Vector4& v) noexcept
+		{
+			*this = *this + v;
+			return *this;
+		}
+
+		constexpr float& operator[](int index) noexcept
+		{
+			assert(index <= 3 && index >= 0);
+
+			if (index == 0) return x;
+			if (index == 1) return y;
+			if (index == 2) return z;
+			return w;
+		}
+
+		constexpr float operator[](int index) const noexcept
+		{
+			assert(index <= 3 && index >= 0);
+
+			if (index == 0) return x;
+			if (index == 1) return y;
+			if (index == 2) return z;
+			return w;
+		}
 	};
+
+	/* --- VECTOR3 CONVERSIONS --- */
+	MATH_INLINE constexpr Vector3::Vector3(const Vector4& v) noexcept : x(v.x), y(v.y), z(v.z) {}
+
+	MATH_INLINE constexpr Vector4 Vector3::ToPoint4() const noexcept
+	{
+		return { x, y, z, 1 };
+	}
+
+	MATH_INLINE constexpr Vector4 Vector3::ToVector4() const noexcept
+	{
+		return { x, y, z, 0 };
+	}
 }
@@ -12,10 +12,16 @@
 #undef main
 #include "HardwareRenderer.h"
 #include "SoftwareRenderer.h"
+#include "OcclusionBuffer.h"
 #include "Camera.h"
+#include "HeadlessBenchmark.h"
+#include "RegressionSuite.h"
+#include "MicroBenchmarks.h"
+#include "Profiler.h"
 
 
-//Force color codes to work
+//Force color codes to work, other terminals understand them already
+#ifdef _WIN32
 #include <Windows.h>
 void enableColors()
 {
@@ -26,6 +32,7 @@ void enableColors()
 		SetConsoleMode(outputHandle, consoleMode | ENABLE_VIRTUAL_TERMINAL_PROCESSING);
 	}
 }
+#endif
 
 using namespace dae;
 
@@ -37,19 +44,23 @@ void ShutDown(SDL_Window* pWindow)
 
 void PrintKeyInfo()
 {
+#ifdef _WIN32
 	enableColors();
 	SetConsoleTitle("DualRasterizer - Lee Vangraefschepe 2DAEGD15N");
+#endif
 	std::cout << "\x1B[2J\x1B[H"; //Clear console
 	std::cout << YELLOW;
 	std::cout << "[Key Bindings - SHARED]\n";
 	std::cout << "  [F1]  Toggle Rasterizer Mode (HARDWARE/SOFTWARE)\n";
 	std::cout << "  [F2]  Toggle Vehicle Rotation (ON/OFF)\n";
+	std::cout << "  [F3]  Toggle FireFX (ON/OFF)\n";
 	std::cout << "  [F9]  Cycle CullMode (BACK/FRONT/NONE)\n";
 	std::cout << "  [F10] Toggle Uniform ClearColor (ON/OFF)\n";
 	std::cout << "  [F11] Toggle Print FPS (ON/OFF)\n";
+	std::cout << "  [O]   Toggle Occlusion Culling (ON/OFF)\n";
+	std::cout << "  [P]   Toggle Profiler Capture (writes Trace.json)\n";
 	std::cout << "\n" << GREEN;
 	std::cout << "[Key Bindings - HARDWARE]\n";
-	std::cout << "  [F3]  Toggle FireFX (ON/OFF)\n";
 	std::cout << "  [F4]  Cycle Sampler State (POINT/LINEAR/ANISOTROPIC)\n";
 	std::cout << "\n" << MAGENTA;
 	std::cout << "[Key Bindings - SOFTWARE]\n";
@@ -57,14 +68,29 @@ void PrintKeyInfo()
 	std::cout << "  [F6]  Toggle NormalMap (ON/OFF)\n";
 	std::cout << "  [F7]  Toggle DepthBuffer Visualization (ON/OFF)\n";
 	std::cout << "  [F8]  Toggle BoundingBox Visualization (ON/OFF)\n";
+	std::cout << "  [F12] Toggle 4x MSAA (ON/OFF)\n";
+	std::cout << "  [R]   Toggle Dynamic Resolution (ON/OFF)\n";
+	std::cout << "  [V]   Toggle Variable Rate Shading (ON/OFF)\n";
+	std::cout << "  [M]   Toggle Meshlet Culling (ON/OFF)\n";
+	std::cout << "  [C]   Capture Frame (Screenshot_<n>.png)\n";
 	std::cout << RESET << "\n\n";
 }
 
 int main(int argc, char* args[])
 {
-	//Unreferenced parameters
-	(void)argc;
-	(void)args;
+	//Software renderer only, no window or DirectX
+	if (HeadlessBenchmark::IsRequested(argc, args))
+	{
+		return HeadlessBenchmark::Run(argc, args);
+	}
+	if (RegressionSuite::IsRequested(argc, args))
+	{
+		return RegressionSuite::Run(argc, args);
+	}
+	if (MicroBenchmarks::IsRequested(argc, args))
+	{
+		return MicroBenchmarks::Run(argc, args);
+	}
 
 	//Create window + surfaces
 	SDL_Init(SDL_INIT_VIDEO);
@@ -94,9 +120,14 @@ int main(int argc, char* args[])
 	const auto pTimer = new Timer();
 	std::vector<GlobalMesh*> pMeshes{};
 
+	//Both renders get their textures and meshes from here, every file is decoded once
+	const auto pAssetCache = new AssetCache{};
+
 	//Initialize renders
-	const auto pHardwareRenderer = new HardwareRenderer(pWindow,pGlobalMeshes, pCamera, pCullmode);
-	const auto pSoftwareRenderer = new SoftwareRenderer(pWindow, pGlobalMeshes, pCamera, pCullmode);
+	const auto pHardwareRenderer = new HardwareRenderer(pWindow,pGlobalMeshes, pCamera, pCullmode, pAssetCache);
+	const auto pSoftwareRenderer = new SoftwareRenderer(pWindow, pGlobalMeshes, pCamera, pCullmode, pAssetCache);
+	pAssetCache->ReleaseUnused();
+	const auto pOcclusionBuffer = new OcclusionBuffer{};
 
 	pCamera->Initialize(static_cast<float>(width) / static_cast<float>(height), 45.f, { 0,0,0 });
 
@@ -106,9 +137,12 @@ int main(int argc, char* args[])
 	bool isLooping = true;
 
 	PrintKeyInfo();
+	Profiler::SetThreadName("Main");
 
 	while (isLooping)
 	{
+		PROFILE_ZONE("Frame");
+
 		//--------- Get input events ---------
 		SDL_Event e;
 		while (SDL_PollEvent(&e))
@@ -150,8 +184,9 @@ int main(int argc, char* args[])
 				}
 				else if (e.key.keysym.scancode == SDL_SCANCODE_F3)
 				{
-					std::cout << GREEN << "**(HARDWARE) FireFX ";
+					std::cout << YELLOW << "**(SHARED) FireFX ";
 					pHardwareRenderer->ToggleFireMesh();
+					pSoftwareRenderer->ToggleFireMesh();
 					std::cout << "\n" << RESET;
 				}
 				else if (e.key.keysym.scancode == SDL_SCANCODE_F4)
@@ -184,6 +219,30 @@ int main(int argc, char* args[])
 					pSoftwareRenderer->ToggleBoundingBox();
 					std::cout << "\n" << RESET;
 				}
+				else if (e.key.keysym.scancode == SDL_SCANCODE_F12)
+				{
+					std::cout << MAGENTA << "**(Software) MSAA ";
+					pSoftwareRenderer->ToggleMultisampling();
+					std::cout << "\n" << RESET;
+				}
+				else if (e.key.keysym.scancode == SDL_SCANCODE_R)
+				{
+					std::cout << MAGENTA << "**(Software) Dynamic Resolution ";
+					pSoftwareRenderer->ToggleDynamicResolution();
+					std::cout << "\n" << RESET;
+				}
+				else if (e.key.keysym.scancode == SDL_SCANCODE_V)
+				{
+					std::cout << MAGENTA << "**(Software) Variable Rate Shading ";
+					pSoftwareRenderer->ToggleVariableRateShading();
+					std::cout << "\n" << RESET;
+				}
+				else if (e.key.keysym.scancode == SDL_SCANCODE_M)
+				{
+					std::cout << MAGENTA << "**(Software) Meshlet Culling ";
+					pSoftwareRenderer->ToggleMeshletCulling();
+					std::cout << "\n" << RESET;
+				}
 				else if (e.key.keysym.scancode == SDL_SCANCODE_F9)
 				{
 					*pCullmode = static_cast<CullMode>((static_cast<int>(*pCullmode) + 1) % 3);
@@ -212,6 +271,40 @@ int main(int argc, char* args[])
 					}
 					std::cout << "\n" << RESET;
 				}
+				else if (e.key.keysym.scancode == SDL_SCANCODE_O)
+				{
+					std::cout << YELLOW << "**(SHARED) Occlusion Culling ";
+					pOcclusionBuffer->ToggleEnabled();
+					std::cout << "\n" << RESET;
+				}
+				else if (e.key.keysym.scancode == SDL_SCANCODE_C && !isHardware)
+				{
+					std::cout << MAGENTA << "**(Software) Capture Frame ";
+					if (pSoftwareRenderer->SaveBufferToImage())
+					{
+						std::cout << "QUEUED";
+					}
+					else
+					{
+						std::cout << "DROPPED (encoder busy)";
+					}
+					std::cout << "\n" << RESET;
+				}
+				else if (e.key.keysym.scancode == SDL_SCANCODE_P)
+				{
+					std::cout << YELLOW << "**(SHARED) Profiler Capture ";
+					if (Profiler::IsCapturing())
+					{
+						const size_t nrZones{ Profiler::EndCapture("Trace.json") };
+						std::cout << "OFF, wrote " << nrZones << " zones to Trace.json";
+					}
+					else
+					{
+						Profiler::BeginCapture();
+						std::cout << "ON";
+					}
+					std::cout << "\n" << RESET;
+				}
 				else if (e.key.keysym.scancode == SDL_SCANCODE_F11)
 				{
 					showFps = !showFps;
@@ -241,7 +334,13 @@ int main(int argc, char* args[])
 			pSoftwareRenderer->Update(pTimer);
 		}
 		
-		pCamera->Update(pTimer);
+		{
+			PROFILE_ZONE("Camera::Update");
+			pCamera->Update(pTimer);
+		}
+
+		//--------- Visibility ---------
+		pOcclusionBuffer->CullMeshes(pGlobalMeshes, *pCamera);
 
 		//--------- Render ---------
 		if (isHardware)
@@ -261,15 +360,39 @@ int main(int argc, char* args[])
 			if (printTimer >= 1.f)
 			{
 				printTimer = 0.f;
-				std::cout << "dFPS: " << pTimer->GetdFPS() << std::endl;
+
+				//Over the frames of the last second, a stutter is a frame over twice the median
+				const FrameStats stats{ pTimer->GetFrameStats(pTimer->GetFPS()) };
+				constexpr double toMilliseconds{ 1e-6 };
+				std::cout << "dFPS: " << pTimer->GetdFPS()
+					<< " | ms min " << stats.minNs * toMilliseconds
+					<< " avg " << stats.avgNs * toMilliseconds
+					<< " p50 " << stats.p50Ns * toMilliseconds
+					<< " p95 " << stats.p95Ns * toMilliseconds
+					<< " p99 " << stats.p99Ns * toMilliseconds
+					<< " max " << stats.maxNs * toMilliseconds
+					<< " | stutters " << stats.nrStutters << '\n';
 			}
 		}
 	}
 	pTimer->Stop();
 
+	//A capture that is still running when the window closes is written as well
+	if (Profiler::IsCapturing())
+	{
+		Profiler::EndCapture("Trace.json");
+	}
+
+	//Frame times of the session, the windows are the last 60, 600 and 3600 frames
+	constexpr size_t frameStatWindows[]{ 60, 600, 3600 };
+	pTimer->GetFrameHistory().WriteCsv("FrameTimes.csv");
+	pTimer->GetFrameHistory().WriteJson("FrameTimes.json", frameStatWindows);
+
 	//Shutdown "framework"
 	delete pHardwareRenderer;
 	delete pSoftwareRenderer;
+	delete pOcclusionBuffer;
+	delete pAssetCache;
 	delete pTimer;
 	delete pCamera;
 	delete pCullmode;
@@ -1,24 +1,16 @@
 #pragma once
 
-#include <iostream>
-#include <vector>
-#include <algorithm>
-#include <sstream>
-#include <memory>
 #define NOMINMAX  //for directx
 
-// SDL Headers
-#include "SDL.h"
+//Everything the software renderer and the headless modes need, SOFTWARE_ONLY builds stop here
+#include "pchSoftware.h"
+
+#ifndef SOFTWARE_ONLY
 #include "SDL_syswm.h"
-#include "SDL_surface.h"
-#include "SDL_image.h"
 
 // DirectX Headers
 #include <dxgi.h>
 #include <d3d11.h>
 #include <d3dcompiler.h>
 #include <d3dx11effect.h>
-
-// Framework Headers
-#include "Timer.h"
-#include "Math.h"
\ No newline at end of file
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include <memory>
+#include <cfloat>
+#include <climits>
+
+// SDL Headers
+#include "SDL.h"
+#include "SDL_surface.h"
+#include "SDL_image.h"
+
+// Framework Headers
+#include "Timer.h"
+#include "Math.h"